@@ -9,16 +9,16 @@ extern "C" const topic_t *local_bus_topics_list(eswb_topic_descr_t td);
 namespace eswb {
 
 Topic *new_Topic(const topic_t *t) {
-    return  new Topic(std::string(t->name),t->type,t->data);
+    return  new Topic(std::string(topic_node(t)->name),(topic_data_type_t) t->type,t->data);
 }
 
 static void process_children(Topic *rt, const topic_t *t) {
-    topic_t *n = t->first_child;
+    topic_t *n = topic_node(t)->first_child;
     while (n != NULL) {
         Topic *tn = new_Topic(n);
         rt->add_child(tn);
         process_children(tn, n);
-        n = n->next_sibling;
+        n = topic_node(n)->next_sibling;
     }
 }
 
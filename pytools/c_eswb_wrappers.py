@@ -1348,6 +1348,8 @@ struct_anon_11.__slots__ = [
     'topic_id',
     'ch_mask',
     'type',
+    'seq',
+    'timestamp',
     'data',
 ]
 struct_anon_11._fields_ = [
@@ -1355,6 +1357,8 @@ struct_anon_11._fields_ = [
     ('topic_id', eswb_topic_id_t),
     ('ch_mask', eswb_event_queue_mask_t),
     ('type', event_queue_record_type_s_t),
+    ('seq', uint32_t),
+    ('timestamp', u_int64_t),
     ('data', POINTER(None)),
 ]
 
@@ -1369,11 +1373,15 @@ struct_event_queue_transfer.__slots__ = [
     'size',
     'topic_id',
     'type',
+    'seq',
+    'timestamp',
 ]
 struct_event_queue_transfer._fields_ = [
     ('size', uint32_t),
     ('topic_id', uint32_t),
     ('type', uint8_t),
+    ('seq', uint32_t),
+    ('timestamp', u_int64_t),
 ]
 
 event_queue_transfer_t = struct_event_queue_transfer# eswb/src/lib/include/public/eswb/event_queue.h: 35
@@ -3,6 +3,7 @@
 #include "eswb/api.h"
 #include "eswb_ctl.h"
 #include "domain_switching.h"
+#include "timing.h"
 
 eswb_rv_t local_buses_init(int do_reset);
 
@@ -11,7 +12,12 @@ eswb_rv_t eswb_local_init(int do_reset) {
 }
 
 eswb_rv_t eswb_create(const char *bus_name, eswb_type_t type, eswb_size_t max_topics) {
-    return ds_create(bus_name, type, max_topics);
+    return ds_create(bus_name, type, max_topics, 0);
+}
+
+eswb_rv_t eswb_create_with_arena(const char *bus_name, eswb_type_t type, eswb_size_t max_topics,
+                                 eswb_size_t arena_size) {
+    return ds_create(bus_name, type, max_topics, arena_size);
 }
 
 eswb_rv_t eswb_delete(const char *bus_path) {
@@ -64,7 +70,6 @@ eswb_rv_t eswb_connect_nested(eswb_topic_descr_t mp_td, const char *topic_name,
     return eswb_connect(full_path, td);
 }
 
-#include <unistd.h>
 
 eswb_rv_t eswb_wait_connect_nested(eswb_topic_descr_t mp_td, const char *topic_name, eswb_topic_descr_t *td,
                                    uint32_t timeout_ms) {
@@ -83,7 +88,7 @@ eswb_rv_t eswb_wait_connect_nested(eswb_topic_descr_t mp_td, const char *topic_n
         rv = eswb_connect(full_path, td);
         if (rv == eswb_e_no_topic) {
 #           define DELAY_MS 50
-            usleep(DELAY_MS * 1000); // TODO platform agnostic
+            timing_sleep_us(DELAY_MS * 1000);
             timer_ms += DELAY_MS;
             if (timer_ms > timeout_ms) {
                 rv = eswb_e_timedout;
@@ -117,6 +122,22 @@ eswb_rv_t eswb_proclaim_tree(eswb_topic_descr_t parent_td, topic_proclaiming_tre
     return eswb_connect_nested(parent_td, bp->name, new_td);
 }
 
+eswb_rv_t eswb_proclaim_alias(eswb_topic_descr_t parent_td, const eswb_topic_descr_t *src_tds, int src_num,
+                              topic_proclaiming_tree_t *bp, eswb_topic_descr_t *new_td) {
+    eswb_rv_t rv;
+
+    if ((bp == NULL) || (src_tds == NULL)) {
+        return eswb_e_invargs;
+    }
+
+    rv = ds_proclaim_alias(parent_td, src_tds, src_num, bp);
+    if (rv != eswb_e_ok) {
+        return rv;
+    }
+
+    return eswb_connect_nested(parent_td, bp->name, new_td);
+}
+
 eswb_rv_t eswb_proclaim_tree_by_path(const char *mount_point, topic_proclaiming_tree_t *bp, eswb_size_t tree_size,
                                      eswb_topic_descr_t *new_td) {
 
@@ -196,10 +217,48 @@ eswb_rv_t eswb_get_update (eswb_topic_descr_t td, void *data) {
     return ds_get_update(td, data);
 }
 
+eswb_rv_t eswb_wait_any(const eswb_topic_descr_t *tds, int n, uint32_t timeout_us, int *ready_mask) {
+    return eswb_wait_any_since(tds, n, NULL, timeout_us, ready_mask);
+}
+
+eswb_rv_t eswb_wait_any_since(const eswb_topic_descr_t *tds, int n, const uint32_t *versions, uint32_t timeout_us,
+                              int *ready_mask) {
+    uint32_t mask = 0;
+
+    if ((tds == NULL) || (ready_mask == NULL)) {
+        return eswb_e_invargs;
+    }
+
+    eswb_rv_t rv = ds_wait_any(tds, n, versions, timeout_us, &mask);
+    *ready_mask = (int) mask;
+
+    return rv;
+}
+
+eswb_rv_t eswb_topic_get_pollfd(eswb_topic_descr_t td, int *fd) {
+    return eswb_ctl(td, eswb_ctl_get_pollfd, fd, sizeof(*fd));
+}
+
 eswb_rv_t eswb_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int size) {
     return ds_ctl(td, ctl_type, d, size);
 }
 
+eswb_rv_t eswb_topic_loan_write(eswb_topic_descr_t td, void **data) {
+    return eswb_ctl(td, eswb_ctl_loan_write, data, sizeof(*data));
+}
+
+eswb_rv_t eswb_topic_commit(eswb_topic_descr_t td) {
+    return eswb_ctl(td, eswb_ctl_commit, NULL, 0);
+}
+
+eswb_rv_t eswb_topic_borrow_read(eswb_topic_descr_t td, const void **data) {
+    return eswb_ctl(td, eswb_ctl_borrow_read, (void *) data, sizeof(*data));
+}
+
+eswb_rv_t eswb_topic_release(eswb_topic_descr_t td) {
+    return eswb_ctl(td, eswb_ctl_release, NULL, 0);
+}
+
 eswb_rv_t eswb_arm_timeout(eswb_topic_descr_t td, uint32_t timeout_us) {
     return eswb_ctl(td, eswb_ctl_arm_timeout, &timeout_us, sizeof(timeout_us));
 }
@@ -208,6 +267,34 @@ eswb_rv_t eswb_get_topic_params (eswb_topic_descr_t td, topic_params_t *params)
     return eswb_ctl(td, eswb_ctl_evq_get_params, params, sizeof(*params));
 }
 
+eswb_rv_t eswb_get_topic_stats (eswb_topic_descr_t td, topic_stats_t *stats) {
+    return eswb_ctl(td, eswb_ctl_get_topic_stats, stats, sizeof(*stats));
+}
+
+eswb_rv_t eswb_get_bus_stats (eswb_topic_descr_t td, bus_stats_t *stats) {
+    return eswb_ctl(td, eswb_ctl_get_bus_stats, stats, sizeof(*stats));
+}
+
+eswb_rv_t eswb_bus_enable_counters (eswb_topic_descr_t td, int enable) {
+    return eswb_ctl(td, eswb_ctl_enable_counters, &enable, sizeof(enable));
+}
+
+eswb_rv_t eswb_get_topic_counters (eswb_topic_descr_t td, topic_counters_t *counters) {
+    return eswb_ctl(td, eswb_ctl_get_topic_counters, counters, sizeof(*counters));
+}
+
+eswb_rv_t eswb_get_wakeup_hist (eswb_topic_descr_t td, topic_wakeup_hist_t *hist) {
+    return eswb_ctl(td, eswb_ctl_get_wakeup_hist, hist, sizeof(*hist));
+}
+
+eswb_rv_t eswb_bus_publish_stats (eswb_topic_descr_t td) {
+    return eswb_ctl(td, eswb_ctl_publish_stats, NULL, 0);
+}
+
+eswb_rv_t eswb_get_version (eswb_topic_descr_t td, uint32_t *version) {
+    return eswb_ctl(td, eswb_ctl_get_version, version, sizeof(*version));
+}
+
 eswb_rv_t eswb_get_next_topic_info (eswb_topic_descr_t td, eswb_topic_id_t *next2tid, struct topic_extract *info) {
     union {
         eswb_topic_id_t             tid;
@@ -251,6 +338,17 @@ eswb_rv_t eswb_fifo_pop(eswb_topic_descr_t td, void *data) {
     return ds_fifo_pop(td, data, 1);
 }
 
+eswb_rv_t eswb_fifo_push_n(eswb_topic_descr_t td, void *elems, eswb_size_t n) {
+    if (n == 0) {
+        return eswb_e_invargs;
+    }
+    return do_update(td, upd_push_fifo, elems, n);
+}
+
+eswb_rv_t eswb_fifo_pop_n(eswb_topic_descr_t td, void *buf, eswb_size_t max, eswb_size_t *got) {
+    return ds_fifo_pop_n(td, buf, max, got, 1);
+}
+
 eswb_rv_t eswb_fifo_flush(eswb_topic_descr_t td) {
     return ds_ctl(td, eswb_ctl_fifo_flush, NULL, 0);
 }
@@ -3,6 +3,7 @@
 
 #include "eswb/bridge.h"
 #include "eswb/api.h"
+#include "timing.h"
 
 
 static eswb_bridge_t* alloc_bridge(eswb_size_t max_tds) {
@@ -40,7 +41,7 @@ eswb_rv_t eswb_bridge_create(const char *name, eswb_size_t max_tds, eswb_bridge_
 
 eswb_rv_t
 eswb_bridge_add_topic(eswb_bridge_t *b, eswb_topic_descr_t mnt_td, const char *src_path, const char *dest_name) {
-    if (b->buffer2post != NULL) {
+    if ((b->buffer2post != NULL) || b->alias) {
         return eswb_e_topic_exist; // TODO change error code;
     }
 
@@ -139,10 +140,41 @@ static eswb_rv_t add_nested_children_to_proclaiming_array(eswb_topic_descr_t fro
     return rv == eswb_e_no_topic ? eswb_e_ok : rv;
 }
 
-eswb_rv_t eswb_bridge_connect(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const char *dest_mnt) {
+static eswb_rv_t proclaim_alias(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const char *dest_mnt,
+                                topic_proclaiming_tree_t *root) {
+    eswb_topic_descr_t src_tds[ESWB_ALIAS_MAX_SOURCES];
+    eswb_rv_t rv;
+
+    if (b->tds_num > ESWB_ALIAS_MAX_SOURCES) {
+        return eswb_e_not_supported;
+    }
+    for (uint32_t i = 0; i < b->tds_num; i++) {
+        src_tds[i] = b->topics[i].td;
+    }
+
+    eswb_topic_descr_t mnt_td = mtd_td;
+    if (mtd_td == 0) {
+        rv = eswb_connect(dest_mnt, &mnt_td);
+        if (rv != eswb_e_ok) {
+            return rv;
+        }
+    }
+
+    rv = eswb_proclaim_alias(mnt_td, src_tds, b->tds_num, root, &b->dest_td);
+
+    if (mtd_td == 0) {
+        eswb_disconnect(mnt_td);
+    }
+
+    return rv;
+}
+
+static eswb_rv_t bridge_connect(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const char *dest_mnt, int alias) {
     uint32_t i;
 
-    b->buffer2post = alloc_buffer(b->buffer2post_size);
+    if (!alias) {
+        b->buffer2post = alloc_buffer(b->buffer2post_size);
+    }
 
     topic_proclaiming_tree_t *root;
 
@@ -203,7 +235,10 @@ eswb_rv_t eswb_bridge_connect(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const
         }
     }
 
-    if (mtd_td == 0) {
+    if (alias) {
+        rv = proclaim_alias(b, mtd_td, dest_mnt, root);
+        b->alias = rv == eswb_e_ok;
+    } else if (mtd_td == 0) {
         rv = eswb_proclaim_tree_by_path(dest_mnt, root, cntx->t_num, &b->dest_td);
     } else {
         rv = eswb_proclaim_tree(mtd_td, root, cntx->t_num, &b->dest_td);
@@ -212,10 +247,19 @@ eswb_rv_t eswb_bridge_connect(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const
     return rv;
 }
 
+eswb_rv_t eswb_bridge_connect(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const char *dest_mnt) {
+    return bridge_connect(b, mtd_td, dest_mnt, 0);
+}
+
+eswb_rv_t eswb_bridge_connect_alias(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const char *dest_mnt) {
+    return bridge_connect(b, mtd_td, dest_mnt, -1);
+}
+
 
 eswb_rv_t eswb_bridge_read(eswb_bridge_t *b, void *data) {
     eswb_size_t offset = 0;
     for (uint32_t i = 0; i < b->tds_num; i++) {
+        eswb_get_version(b->topics[i].td, &b->topics[i].version);
         eswb_read(b->topics[i].td, data + offset);
         offset += b->topics[i].size;
     }
@@ -223,13 +267,145 @@ eswb_rv_t eswb_bridge_read(eswb_bridge_t *b, void *data) {
     return eswb_e_ok;
 }
 
+eswb_rv_t eswb_bridge_read_snapshot(eswb_bridge_t *b, void *data) {
+    uint32_t v;
+    eswb_rv_t rv;
+
+    for (int attempt = 0; attempt < BRIDGE_SNAPSHOT_ATTEMPTS; attempt++) {
+        // first attempt reads everything, next ones only topics updated since their copy was taken
+        eswb_size_t offset = 0;
+        for (uint32_t i = 0; i < b->tds_num; i++) {
+            struct topics_subsriptions *ts = &b->topics[i];
+            rv = eswb_get_version(ts->td, &v);
+            if (rv != eswb_e_ok) {
+                return rv;
+            }
+            if ((attempt == 0) || (v != ts->version)) {
+                ts->version = v;
+                rv = eswb_read(ts->td, data + offset);
+                if (rv != eswb_e_ok) {
+                    return rv;
+                }
+            }
+            offset += ts->size;
+        }
+
+        // copies are consistent if none of the sources changed after all of them were read
+        int consistent = -1;
+        for (uint32_t i = 0; (i < b->tds_num) && consistent; i++) {
+            eswb_get_version(b->topics[i].td, &v);
+            consistent = v == b->topics[i].version;
+        }
+        if (consistent) {
+            return eswb_e_ok;
+        }
+    }
+
+    return eswb_e_sync_inconsistent;
+}
+
+static eswb_rv_t bridge_post(eswb_bridge_t *b, eswb_rv_t read_rv) {
+    if (read_rv != eswb_e_ok) {
+        return read_rv;
+    }
+    return eswb_update_topic(b->dest_td, b->buffer2post);
+}
+
 eswb_rv_t eswb_bridge_update(eswb_bridge_t *b) {
 
     if (b == NULL) {
         return eswb_e_invargs;
     }
+    if (b->alias) {
+        // destination is the sources' memory itself, nothing to post
+        return eswb_e_ok;
+    }
+
+    return bridge_post(b, eswb_bridge_read(b, b->buffer2post));
+}
 
-    eswb_bridge_read(b, b->buffer2post);
+eswb_rv_t eswb_bridge_update_snapshot(eswb_bridge_t *b) {
 
-    return eswb_update_topic(b->dest_td, b->buffer2post);
+    if (b == NULL) {
+        return eswb_e_invargs;
+    }
+    if (b->alias) {
+        // destination is the sources' memory itself, nothing to post
+        return eswb_e_ok;
+    }
+
+    return bridge_post(b, eswb_bridge_read_snapshot(b, b->buffer2post));
+}
+
+eswb_rv_t eswb_bridge_set_trigger(eswb_bridge_t *b, eswb_bridge_trigger_t trigger, uint32_t min_interval_us) {
+    if ((b == NULL) || (trigger > eswb_bridge_on_all)) {
+        return eswb_e_invargs;
+    }
+    b->trigger = trigger;
+    b->min_interval_us = min_interval_us;
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t eswb_bridge_wait_update(eswb_bridge_t *b, uint32_t timeout_us) {
+    eswb_topic_descr_t wait_tds[ESWB_WAIT_ANY_MAX_TOPICS];
+    uint32_t wait_versions[ESWB_WAIT_ANY_MAX_TOPICS];
+    uint32_t v;
+    eswb_rv_t rv;
+
+    if ((b == NULL) || (b->buffer2post == NULL)) {
+        return eswb_e_invargs;
+    }
+    if (b->tds_num > ESWB_WAIT_ANY_MAX_TOPICS) {
+        return eswb_e_not_supported;
+    }
+
+    uint64_t deadline = timing_now_us() + timeout_us;
+
+    for (;;) {
+        // versions of the last snapshot are the ones the destination was updated with
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < b->tds_num; i++) {
+            rv = eswb_get_version(b->topics[i].td, &v);
+            if (rv != eswb_e_ok) {
+                return rv;
+            }
+            if (v == b->topics[i].version) {
+                wait_tds[n] = b->topics[i].td;
+                wait_versions[n] = v;
+                n++;
+            }
+        }
+
+        int triggered = b->trigger == eswb_bridge_on_all ? n == 0 : n < b->tds_num;
+        if (triggered) {
+            break;
+        }
+
+        uint32_t wait_us = 0;
+        if (timeout_us > 0) {
+            uint64_t now = timing_now_us();
+            if (now >= deadline) {
+                return eswb_e_timedout;
+            }
+            wait_us = deadline - now;
+        }
+
+        // only unchanged sources are awaited, otherwise the changed ones keep waking up the "all" mode
+        int ready_mask;
+        rv = eswb_wait_any_since(wait_tds, n, wait_versions, wait_us, &ready_mask);
+        if (rv != eswb_e_ok) {
+            return rv;
+        }
+    }
+
+    // updates arriving within the interval are coalesced into a single one
+    uint64_t next_post = b->last_post_us + b->min_interval_us;
+    uint64_t now = timing_now_us();
+    if (now < next_post) {
+        timing_sleep_us(next_post - now);
+    }
+    b->last_post_us = timing_now_us();
+
+    return eswb_bridge_update_snapshot(b);
 }
@@ -142,13 +142,13 @@ eswb_rv_t eswb_lookup_in_domain(const char *bus_name, eswb_type_t type, eswb_bus
             return local_lookup_itb(bus_name, b);
 
         case eswb_inter_process:
-            return eswb_e_not_supported;
+            return local_lookup_ipb(bus_name, b);
 
         case eswb_not_defined:
             ;
             eswb_rv_t rv = local_lookup_any(bus_name, b);
-            if (rv != eswb_e_ok) {
-                // TODO here must be lookup for inter process bus
+            if (rv == eswb_e_bus_not_exist) {
+                rv = local_lookup_ipb(bus_name, b);
             }
             return rv;
 
@@ -174,16 +174,16 @@ bus_lookup(const char *connection_point, eswb_bus_handle_t **bh, eswb_type_t *bu
     return eswb_lookup_in_domain(bus_name, e_bus_type, bh);
 }
 
-eswb_rv_t ds_create(const char *bus_name, eswb_type_t type, eswb_size_t max_topics) {
+eswb_rv_t ds_create(const char *bus_name, eswb_type_t type, eswb_size_t max_topics, eswb_size_t arena_size) {
     switch (type) {
         case eswb_inter_thread:
-            return local_bus_itb_create(bus_name, max_topics);
+            return local_bus_itb_create(bus_name, max_topics, arena_size);
 
         case eswb_inter_process:
-            return eswb_e_not_supported;
+            return local_bus_ipb_create(bus_name, max_topics, arena_size);
 
         case eswb_non_synced:
-            return local_bus_nsb_create(bus_name, max_topics);
+            return local_bus_nsb_create(bus_name, max_topics, arena_size);
 
         default:
             return eswb_e_invargs;
@@ -202,10 +202,8 @@ eswb_rv_t ds_delete(const char *bus_path) {
     }
 
     switch (bus_type) {
-        case eswb_inter_process:
-            return eswb_e_not_supported;
-
         case eswb_not_defined:
+        case eswb_inter_process:
         case eswb_inter_thread:
         case eswb_non_synced:
             return local_bus_delete(bh);
@@ -231,6 +229,7 @@ eswb_rv_t ds_connect(const char *connection_point, eswb_topic_descr_t *td) {
         case eswb_not_defined: // FIXME
         case eswb_non_synced:
         case eswb_inter_thread:
+        case eswb_inter_process: // segment is mapped into the process, so its topics are served by local calls
             rv = local_bus_connect(bh, cp, td);
             if (rv != eswb_e_ok) {
                 return rv;
@@ -238,9 +237,6 @@ eswb_rv_t ds_connect(const char *connection_point, eswb_topic_descr_t *td) {
             *td = -(*td);
             return rv;
 
-        case eswb_inter_process:
-            return eswb_e_not_supported;
-
         default:
             return eswb_e_invargs;
     }
@@ -260,10 +256,13 @@ eswb_rv_t not_supported_stub(eswb_topic_descr_t td, ...) {
 }
 
 eswb_rv_t ds_disconnect(eswb_topic_descr_t td) {
-    SWITCH_FLOW_TO_DOMAIN(td,
-                          not_supported_stub,
-                          not_supported_stub,
-                          1);
+    if (td < 0) {
+        return local_disconnect(-td);
+    } else if (td > 0) {
+        return eswb_e_not_supported;
+    } else {
+        return eswb_e_invargs;
+    }
 }
 
 
@@ -300,6 +299,16 @@ eswb_rv_t ds_fifo_pop(eswb_topic_descr_t td, void *data, int do_wait) {
                           do_wait);
 }
 
+eswb_rv_t ds_fifo_pop_n(eswb_topic_descr_t td, void *data, eswb_size_t max, eswb_size_t *got, int do_wait) {
+    SWITCH_FLOW_TO_DOMAIN(td,
+                          local_fifo_pop_n,
+                          not_supported_stub,
+                          data,
+                          max,
+                          got,
+                          do_wait);
+}
+
 
 eswb_rv_t ds_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int size) {
     SWITCH_FLOW_TO_DOMAIN(td,
@@ -308,3 +317,50 @@ eswb_rv_t ds_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int size)
 
                           ctl_type, d, size);
 }
+
+eswb_rv_t ds_proclaim_alias(eswb_topic_descr_t mnt_td, const eswb_topic_descr_t *src_tds, int src_num,
+                            topic_proclaiming_tree_t *tree) {
+    eswb_topic_descr_t local_tds[ESWB_ALIAS_MAX_SOURCES];
+
+    if ((src_num <= 0) || (src_num > ESWB_ALIAS_MAX_SOURCES)) {
+        return eswb_e_invargs;
+    }
+
+    // alias shares memory of the sources, so it is possible within the local domain only
+    if (mnt_td >= 0) {
+        return mnt_td == 0 ? eswb_e_invargs : eswb_e_not_supported;
+    }
+    for (int i = 0; i < src_num; i++) {
+        if (src_tds[i] < 0) {
+            local_tds[i] = -src_tds[i];
+        } else if (src_tds[i] > 0) {
+            return eswb_e_not_supported;
+        } else {
+            return eswb_e_invargs;
+        }
+    }
+
+    return local_proclaim_alias(-mnt_td, local_tds, src_num, tree);
+}
+
+eswb_rv_t ds_wait_any(const eswb_topic_descr_t *tds, int n, const uint32_t *versions, uint32_t timeout_us,
+                      uint32_t *ready_mask) {
+    eswb_topic_descr_t local_tds[ESWB_WAIT_ANY_MAX_TOPICS];
+
+    if ((n <= 0) || (n > ESWB_WAIT_ANY_MAX_TOPICS)) {
+        return eswb_e_invargs;
+    }
+
+    // mixing domains is not possible, listener works within a single one
+    for (int i = 0; i < n; i++) {
+        if (tds[i] < 0) {
+            local_tds[i] = -tds[i];
+        } else if (tds[i] > 0) {
+            return eswb_e_not_supported;
+        } else {
+            return eswb_e_invargs;
+        }
+    }
+
+    return local_wait_any(local_tds, n, versions, timeout_us, ready_mask);
+}
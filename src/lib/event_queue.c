@@ -35,6 +35,30 @@ eswb_rv_t eswb_event_queue_enable(eswb_topic_descr_t td, eswb_size_t queue_size,
     return eswb_ctl(td, eswb_ctl_enable_event_queue, &params, sizeof(params));
 }
 
+/**
+ * Enable event queue where channels of subch_mask get own sub-queues. Consumer whose receive mask is a single
+ * one of these channels pops its events only, instead of skipping all other events of the queue.
+ * Sub-queues hold queue_size positions each and occupy no space in the buffer.
+ */
+eswb_rv_t eswb_event_queue_enable_subch(eswb_topic_descr_t td, eswb_size_t queue_size, eswb_size_t buffer_size,
+                                        eswb_event_queue_mask_t subch_mask) {
+    eswb_size_t params[3] = {queue_size, buffer_size, subch_mask};
+    return eswb_ctl(td, eswb_ctl_enable_event_queue, &params, sizeof(params));
+}
+
+/**
+ * Enable conflating event queue, it keeps the latest event of every topic only. Newer update or push of the topic
+ * replaces the pending one, so consumer that is slower than the bus gets the freshest state of every topic
+ * and never underruns. Every proclamation and every updated or pushed topic occupy a slot with data region of
+ * the event's size till the bus is deleted.
+ * @param slots_num number of slots
+ * @param buffer_size overall size of slots' data
+ */
+eswb_rv_t eswb_event_queue_enable_conflating(eswb_topic_descr_t td, eswb_size_t slots_num, eswb_size_t buffer_size) {
+    eswb_size_t params[4] = {slots_num, buffer_size, 0, 1};
+    return eswb_ctl(td, eswb_ctl_enable_event_queue, &params, sizeof(params));
+}
+
 eswb_rv_t eswb_event_queue_subscribe(const char *bus_path, eswb_topic_descr_t *td) {
     char path[ESWB_TOPIC_MAX_PATH_LEN + 1];
 
@@ -54,6 +78,15 @@ eswb_rv_t eswb_event_queue_subscribe(const char *bus_path, eswb_topic_descr_t *t
     return rv;
 }
 
+/**
+ * Stamp events with CLOCK_MONOTONIC time of publishing, it is delivered along with event's sequence number
+ * to consumers and through replication, so latency is measured against the origin bus's clock
+ * @param td any topic of the bus
+ */
+eswb_rv_t eswb_event_queue_set_timestamping(eswb_topic_descr_t td, int enable) {
+    return eswb_ctl(td, eswb_ctl_evq_set_timestamping, &enable, sizeof(enable));
+}
+
 eswb_rv_t eswb_event_queue_set_receive_mask(eswb_topic_descr_t td, eswb_event_queue_mask_t mask) {
     return eswb_ctl(td, eswb_ctl_evq_set_receive_mask, &mask, sizeof(mask));
 }
@@ -191,12 +224,23 @@ eswb_rv_t map_find(topic_id_map_t *map_handle, uint32_t src_id_key, eswb_topic_d
  *  - source topic id is identified by root topic, e.i. first one (as proclaimed)
  */
 
+/**
+ * Apply event popped from the other bus's queue. Events it produces in the replica's queue keep seq and timestamp
+ * of the origin, so consumers of the replica measure latency and detect events lost on the way against the origin.
+ * Events with seq 0 (e.g. initial sync of EQRB) and events published on the replica itself are numbered by the
+ * replica's queue.
+ */
 eswb_rv_t eswb_event_queue_replicate(eswb_topic_descr_t mount_point_td, struct topic_id_map *map_handle, event_queue_transfer_t *event) {
 
     eswb_rv_t rv = eswb_e_ok; // TODO no_effect?
 
     eswb_rv_t lookup_rv;
 
+    event_queue_origin_t origin = {
+            .timestamp = event->timestamp,
+            .seq = event->seq
+    };
+
     switch (event->type) {
         case eqr_topic_proclaim:
             if ((event->size % sizeof(topic_proclaiming_tree_t))) {
@@ -230,6 +274,7 @@ eswb_rv_t eswb_event_queue_replicate(eswb_topic_descr_t mount_point_td, struct t
 
             eswb_topic_descr_t new_td;
 
+            eswb_ctl(proclaiming_td, eswb_ctl_arm_event_origin, &origin, sizeof(origin));
             // TODO Security issue: must check indexes before proclaiming it the whole thing.
             rv = eswb_proclaim_tree(proclaiming_td, root,
                                             event->size / sizeof(topic_proclaiming_tree_t), &new_td);
@@ -246,6 +291,7 @@ eswb_rv_t eswb_event_queue_replicate(eswb_topic_descr_t mount_point_td, struct t
             eswb_topic_descr_t td;
             lookup_rv = map_find(map_handle, event->topic_id, &td);
             if (lookup_rv == eswb_e_ok) {
+                eswb_ctl(td, eswb_ctl_arm_event_origin, &origin, sizeof(origin));
                 rv = eswb_update_topic(td, EVENT_QUEUE_TRANSFER_DATA(event));
             } else {
                 rv = lookup_rv;
@@ -257,6 +303,7 @@ eswb_rv_t eswb_event_queue_replicate(eswb_topic_descr_t mount_point_td, struct t
             ;
             lookup_rv = map_find(map_handle, event->topic_id, &td);
             if (lookup_rv == eswb_e_ok) {
+                eswb_ctl(td, eswb_ctl_arm_event_origin, &origin, sizeof(origin));
                 // TODO lame convention regarding the writing td (fifo or struct inside) likely will raise here:
                 rv = eswb_fifo_push(td, EVENT_QUEUE_TRANSFER_DATA(event));
             } else {
@@ -11,6 +11,7 @@ typedef enum local_bus_type_e {
     local_bus_t_synced,
     local_bus_t_nonsynced,
     local_bus_t_synced_or_nonsynced,
+    local_bus_t_interprocess,
 } local_bus_type_t;
 
 typedef struct eswb_bus_handle {
@@ -20,13 +21,26 @@ typedef struct eswb_bus_handle {
     local_bus_type_t local_type;
 
     eswb_topic_descr_t event_queue_publisher_td;
+
+    struct shm_segment *shm; // registry's shared memory for interprocess bus
+    int shm_owner; // segment is created by this process
+
+    eswb_topic_descr_t stats_dir_td;    // statistics subtree, published by this process
+    eswb_topic_descr_t *stats_tds;      // statistics topics by ids of the topics they describe
 } eswb_bus_handle_t;
 
 typedef struct {
-    eswb_fifo_index_t tail;
+    eswb_fifo_index_t tail; // slot of the last popped event for conflating event queue
     eswb_fifo_index_t lap;
+    uint32_t seq; // conflating event queue only: sequence number of the last popped event
 } fifo_rcvr_state_t;
 
+typedef enum {
+    loan_none = 0,
+    loan_write,
+    loan_read,
+} topic_loan_state_t;
+
 typedef struct {
     topic_t *t;
 
@@ -36,8 +50,17 @@ typedef struct {
     fifo_rcvr_state_t rcvr_state;
 
     eswb_event_queue_mask_t event_queue_mask; // this mask is used by EQ call for check desired topics
+    topic_t *event_subqueue; // sub-queue of the event queue for the receive mask, NULL if whole queue is filtered
 
     uint32_t timeout_us;
+    event_queue_origin_t event_origin; // stamps for events of the next update instead of local ones, armed by replication
+
+    topic_loan_state_t loan_state;
+
+    struct topic_local_pollfd *pollfd; // eventfd listener attached by eswb_topic_get_pollfd
+
+    int allocated; // descriptor is in use, cleared by eswb_disconnect
+    eswb_topic_descr_t next_free; // next released descriptor while this one is released too
 
 } topic_local_index_t;
 
@@ -48,7 +71,10 @@ extern "C" {
 eswb_rv_t local_buses_init(int do_reset);
 
 eswb_rv_t local_bus_alloc_topic_descr(eswb_bus_handle_t *bh, topic_t *t, eswb_topic_descr_t *td);
+eswb_rv_t local_disconnect(eswb_topic_descr_t td);
 eswb_rv_t local_do_update(eswb_topic_descr_t td, eswb_update_t ut, void *data, eswb_size_t elem_num);
+eswb_rv_t local_proclaim_alias(eswb_topic_descr_t mnt_td, const eswb_topic_descr_t *src_tds, int src_num,
+                               topic_proclaiming_tree_t *tree);
 eswb_rv_t local_do_read(eswb_topic_descr_t td, void *data);
 eswb_rv_t local_get_update(eswb_topic_descr_t td, void *data);
 
@@ -56,20 +82,29 @@ eswb_rv_t local_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int siz
 
 eswb_rv_t local_init_fifo_receiver(eswb_topic_descr_t td);
 eswb_rv_t local_fifo_pop(eswb_topic_descr_t td, void *data, int do_wait);
+eswb_rv_t local_fifo_pop_n(eswb_topic_descr_t td, void *data, eswb_size_t max, eswb_size_t *got, int do_wait);
 
 eswb_rv_t local_get_params(eswb_topic_descr_t td, topic_params_t *params);
+eswb_rv_t local_get_stats(eswb_topic_descr_t td, topic_stats_t *stats);
+eswb_rv_t local_wait_any(const eswb_topic_descr_t *tds, int n, const uint32_t *versions, uint32_t timeout_us,
+                         uint32_t *ready_mask);
 void local_busses_print_registry(eswb_bus_handle_t *bh);
 
-eswb_rv_t local_bus_itb_create(const char *bus_name, eswb_size_t max_topics);
+eswb_rv_t local_bus_itb_create(const char *bus_name, eswb_size_t max_topics, eswb_size_t arena_size);
 eswb_rv_t local_lookup_itb(const char *bus_name, eswb_bus_handle_t **b);
 
-eswb_rv_t local_bus_nsb_create(const char *bus_name, eswb_size_t max_topics);
+eswb_rv_t local_bus_nsb_create(const char *bus_name, eswb_size_t max_topics, eswb_size_t arena_size);
 eswb_rv_t local_lookup_nsb(const char *bus_name, eswb_bus_handle_t **b);
 eswb_rv_t local_lookup_any(const char *bus_name, eswb_bus_handle_t **b);
 
+eswb_rv_t local_bus_ipb_create(const char *bus_name, eswb_size_t max_topics, eswb_size_t arena_size);
+eswb_rv_t local_lookup_ipb(const char *bus_name, eswb_bus_handle_t **b);
+
 eswb_rv_t local_bus_delete(eswb_bus_handle_t *bh);
 
 eswb_rv_t local_bus_connect(eswb_bus_handle_t *bh, const char *conn_pnt, eswb_topic_descr_t *td);
+eswb_rv_t local_bus_create_event_queue(eswb_bus_handle_t *bh, eswb_size_t events_num, eswb_size_t data_buf_size,
+                                       eswb_event_queue_mask_t subch_mask, int conflating);
 
 #ifdef __cplusplus
 }
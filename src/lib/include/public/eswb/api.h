@@ -31,12 +31,28 @@ eswb_rv_t eswb_local_init(int do_reset);
  * @param type
  *   eswb_non_synced    - no synchronization and mutual exclusion are provided for topics access
  *   eswb_inter_thread  - with synchronized access to topics and with blocked updated calls
- *   eswb_inter_process - NOT SUPPORTED YET; will create a broker process
- * @param max_topics number of topics to allocate inside a bus registry
+ *   eswb_inter_process - same as eswb_inter_thread, but the registry lives in a named shared memory segment, so the
+ *                        bus is reachable from other processes by "ipb:/bus_name" paths. eswb_wait_any and
+ *                        poll descriptors are not supported for its topics
+ * @param max_topics maximum number of topics inside a bus registry, memory for topics is allocated when they are
+ *                   proclaimed
  * @return eswb_e_ok on success
  */
 eswb_rv_t eswb_create(const char *bus_name, eswb_type_t type, eswb_size_t max_topics);
 
+/**
+ * Create a bus with its topics, their data, FIFO extensions and syncs placed in a single arena, each of them in
+ * cache line aligned slots. Arena is allocated at once and released when the bus is deleted
+ * @param bus_name
+ * @param type same as for eswb_create
+ * @param max_topics same as for eswb_create
+ * @param arena_size arena size in bytes; for eswb_inter_process it is the size of the shared memory segment; proclaiming
+ * fails with eswb_e_mem_topic_na or eswb_e_mem_data_na when arena is exhausted
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_create_with_arena(const char *bus_name, eswb_type_t type, eswb_size_t max_topics,
+                                 eswb_size_t arena_size);
+
 /**
  * Delete bus by its name
  * @param bus_path path / name of the bus
@@ -79,6 +95,23 @@ eswb_rv_t eswb_mkdir_nested(eswb_topic_descr_t parent_td, const char *dir_name,
 eswb_rv_t eswb_proclaim_tree(eswb_topic_descr_t parent_td, topic_proclaiming_tree_t *bp, eswb_size_t tree_size,
                              eswb_topic_descr_t *new_td);
 
+/**
+ * Publish tree of the topics which root has no memory of its own, but is mapped onto memory of existing topics,
+ * possibly of the other bus. Root shares sync of the sources, so reading or waiting on it costs the same as on sources.
+ * Sources must outlive the alias.
+ * @param parent_td topic descriptor of the root, must have type tt_dir
+ * @param src_tds source topics laying one after another inside the same structure (or a single topic)
+ * @param src_num number of sources, ESWB_ALIAS_MAX_SOURCES at most
+ * @param bp tree initialized by usr_topic_* calls, root's size must be equal to the sum of sources' sizes,
+ *  children must be TOPIC_FLAG_MAPPED_TO_PARENT
+ * @param new_td pointer to topic descriptor variable assigned to the just published topic, might be NULL
+ * @return eswb_e_ok on success
+ *  eswb_e_invargs if sources are not contiguous or don't match the root
+ *  eswb_e_not_supported if buses are synced differently or inter process
+ */
+eswb_rv_t eswb_proclaim_alias(eswb_topic_descr_t parent_td, const eswb_topic_descr_t *src_tds, int src_num,
+                              topic_proclaiming_tree_t *bp, eswb_topic_descr_t *new_td);
+
 /**
  * Publish tree of the topics to the specified path
  * @param mount_point path to the topic the root to publish, must have type tt_dir
@@ -108,6 +141,25 @@ eswb_rv_t eswb_proclaim_plain(const char *mount_point, const char *topic_name, s
  */
 eswb_rv_t eswb_update_topic (eswb_topic_descr_t td, void *data);
 
+/**
+ * Get pointer to topic's data to fill it in place instead of copying by eswb_update_topic. On synced busses topic
+ * stays locked till eswb_topic_commit call, so keep the section short. Commit must be called by the loaning thread
+ * @param td topic descriptor
+ * @param data pointer to save data pointer; the buffer has a size according to the topic size
+ * @return eswb_e_ok on success
+ *  eswb_e_not_supported for fifos, event queues and topics without data
+ *  eswb_e_invargs if the descriptor already holds a loan
+ */
+eswb_rv_t eswb_topic_loan_write(eswb_topic_descr_t td, void **data);
+
+/**
+ * Publish data filled in place after eswb_topic_loan_write and notify blocked subscribers
+ * @param td topic descriptor
+ * @return eswb_e_ok on success
+ *  eswb_e_invargs if there is no write loan on the descriptor
+ */
+eswb_rv_t eswb_topic_commit(eswb_topic_descr_t td);
+
 /**
  * Subscribe on topic
  * @param path2topic path to the topic to subscribe
@@ -117,13 +169,35 @@ eswb_rv_t eswb_update_topic (eswb_topic_descr_t td, void *data);
 eswb_rv_t eswb_connect(const char *path2topic, eswb_topic_descr_t *new_td);
 
 /**
- * Non blocking read of topic's current value
+ * Non blocking read of topic's current value. On synced busses the read does not take topic's lock, consistency
+ * is guaranteed by the seqlock counter updated by the publisher. Slow readers of big topics might fall back to the
+ * lock; topics proclaimed with TOPIC_FLAG_TRIPLE_BUFFER copy the latest complete buffer and take the lock only if
+ * the publisher keeps overtaking the copy
  * @param td topic descriptor
  * @param data data to read; must have a size according to the topic size
  * @return eswb_e_ok on success
  */
 eswb_rv_t eswb_read (eswb_topic_descr_t td, void *data);
 
+/**
+ * Get pointer to topic's data to parse it in place instead of copying by eswb_read. On synced busses publishers are
+ * blocked till eswb_topic_release call, so keep the section short
+ * @param td topic descriptor
+ * @param data pointer to save data pointer; the buffer has a size according to the topic size
+ * @return eswb_e_ok on success
+ *  eswb_e_not_supported for fifos, event queues, topics without data and triple buffered topics
+ *  eswb_e_invargs if the descriptor already holds a loan
+ */
+eswb_rv_t eswb_topic_borrow_read(eswb_topic_descr_t td, const void **data);
+
+/**
+ * Release data borrowed by eswb_topic_borrow_read, must be called by the borrowing thread
+ * @param td topic descriptor
+ * @return eswb_e_ok on success
+ *  eswb_e_invargs if there is no read loan on the descriptor
+ */
+eswb_rv_t eswb_topic_release(eswb_topic_descr_t td);
+
 /**
  * Blocking read of topic's value, returned right after its value publication
  * @param td topic descriptor
@@ -132,6 +206,40 @@ eswb_rv_t eswb_read (eswb_topic_descr_t td, void *data);
  */
 eswb_rv_t eswb_get_update (eswb_topic_descr_t td, void *data);
 
+/**
+ * Wait till any of the topics is updated, so a single thread can serve several inputs. FIFOs and event queues are
+ * ready right away while the descriptor has elements to pop, other topics get ready by the next update after the call.
+ * Data is not consumed, use eswb_read or eswb_fifo_pop for ready topics.
+ * @param tds array of topic descriptors of synchronized buses
+ * @param n number of descriptors, ESWB_WAIT_ANY_MAX_TOPICS at most
+ * @param timeout_us timeout in microseconds, 0 to wait without timeout
+ * @param ready_mask bit mask of ready topics, bit i stands for tds[i]
+ * @return eswb_e_ok on success
+ *  eswb_e_timedout if nothing got ready within the timeout
+ *  eswb_e_not_supported for non synced buses
+ */
+eswb_rv_t eswb_wait_any(const eswb_topic_descr_t *tds, int n, uint32_t timeout_us, int *ready_mask);
+
+/**
+ * Same as eswb_wait_any, but a topic is also ready right away if its version (see eswb_get_version) differs from
+ * the given one, so updates done before the call are not missed
+ * @param versions array of n versions the caller has seen, NULL to behave as eswb_wait_any
+ */
+eswb_rv_t eswb_wait_any_since(const eswb_topic_descr_t *tds, int n, const uint32_t *versions, uint32_t timeout_us,
+                              int *ready_mask);
+
+/**
+ * Get file descriptor signalled on every topic's update, fifo push or event queue push, to be used with
+ * poll/epoll/select next to other descriptors. It is a non-blocking eventfd, read 8 bytes from it to reset the
+ * signal. FIFOs and event queues with elements to pop signal the descriptor right away.
+ * Descriptor is created by the first call and stays owned by the topic descriptor, don't close it.
+ * @param td topic descriptor of synchronized bus
+ * @param fd pointer to store file descriptor
+ * @return eswb_e_ok on success
+ *  eswb_e_not_supported for non synced buses and platforms without eventfd
+ */
+eswb_rv_t eswb_topic_get_pollfd(eswb_topic_descr_t td, int *fd);
+
 /**
  * Get topic's information by its descriptor
  * @param td topic descriptor
@@ -140,6 +248,71 @@ eswb_rv_t eswb_get_update (eswb_topic_descr_t td, void *data);
  */
 eswb_rv_t eswb_get_topic_params (eswb_topic_descr_t td, topic_params_t *params);
 
+/**
+ * Get topic's runtime statistics: how many updates woke up blocked subscribers and how many skipped the wake up
+ * as nobody was blocked
+ * @param td topic descriptor
+ * @param stats pointer to an allocated statistics structure to store counters on success
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_get_topic_stats (eswb_topic_descr_t td, topic_stats_t *stats);
+
+/**
+ * Get statistics of the bus the topic belongs to: number of topics and memory footprint
+ * @param td topic descriptor of any bus's topic
+ * @param stats pointer to an allocated statistics structure to store counters on success
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_get_bus_stats (eswb_topic_descr_t td, bus_stats_t *stats);
+
+/**
+ * Enable or disable per-topic counters of the bus: updates, reads, waits, timeouts, underruns, bytes and the time of
+ * the last update. They are maintained by every thread and process accessing the bus's topics while enabled.
+ * @param td topic descriptor of any bus's topic
+ * @param enable nonzero to enable
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_bus_enable_counters (eswb_topic_descr_t td, int enable);
+
+/**
+ * Get topic's counters, they are accounted to the topic the descriptor is connected to
+ * @param td topic descriptor
+ * @param counters pointer to an allocated structure to store counters on success
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_get_topic_counters (eswb_topic_descr_t td, topic_counters_t *counters);
+
+/**
+ * Get histogram of wakeup latencies of topic's blocking calls (eswb_get_update, blocking pops): time from the update
+ * waking them up till they resume. There is no separate switch: latencies are measured only while bus's counters
+ * are enabled (eswb_bus_enable_counters), both at the update and at the start of the wait, and are accounted to the
+ * topic the call waited on. Wakeup time is kept by the topic owning the sync, so struct members sharing their
+ * parent's sync measure from the latest update of any of them.
+ * @param td topic descriptor
+ * @param hist pointer to an allocated histogram to store buckets on success
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_get_wakeup_hist (eswb_topic_descr_t td, topic_wakeup_hist_t *hist);
+
+/**
+ * Publish counters of the bus's active topics to BUS_STATS_DIR_NAME subtree of the bus, where every topic has
+ * a structure named by its id (see eswb_get_next_topic_info). Structures are regular topics, so they can be
+ * read, bridged and replicated. Call it periodically from a single thread; each active topic takes 8 topics of the bus.
+ * @param td topic descriptor of any bus's topic
+ * @return eswb_e_ok on success
+ *  eswb_e_mem_topic_na if bus has no room for statistics topics
+ */
+eswb_rv_t eswb_bus_publish_stats (eswb_topic_descr_t td);
+
+/**
+ * Get version of topic's data, it changes on every update of the topic (and of topics sharing its structure).
+ * Equal versions taken before and after eswb_read guarantee the read data was not overwritten in between.
+ * @param td topic descriptor
+ * @param version pointer to store version
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_get_version (eswb_topic_descr_t td, uint32_t *version);
+
 
 /**
  * Retrieve topics
@@ -189,6 +362,27 @@ eswb_rv_t eswb_fifo_push(eswb_topic_descr_t td, void *data);
  */
 eswb_rv_t eswb_fifo_pop(eswb_topic_descr_t td, void *data);
 
+/**
+ * Push a contiguous run of elements to fifo under a single lock and a single wake up of subscribers
+ * @param td fifo's topic descriptor
+ * @param elems pointer to elements to push; each must have a size according to the fifo element size
+ * @param n number of elements
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_fifo_push_n(eswb_topic_descr_t td, void *elems, eswb_size_t n);
+
+/**
+ * Pop all available elements, but not more than max, under a single lock. Blocks till at least one element arrives
+ * @param td fifo's topic descriptor
+ * @param buf pointer to save popped elements; must have a size of max fifo elements
+ * @param max maximum number of elements to pop
+ * @param got pointer to save number of popped elements
+ * @return eswb_e_ok on success
+ * eswb_e_fifo_rcvr_underrun if receiver was overrun, elements are popped starting from the oldest one available
+ * eswb_e_no_update if FIFO is created on NSB bus type and there are no elements in queue
+ */
+eswb_rv_t eswb_fifo_pop_n(eswb_topic_descr_t td, void *buf, eswb_size_t max, eswb_size_t *got);
+
 /**
  * Flush fifo for specified td
  * @param td fifo's topic descriptor
@@ -240,9 +434,11 @@ eswb_rv_t
 eswb_wait_connect_nested(eswb_topic_descr_t mp_td, const char *topic_name, eswb_topic_descr_t *td, uint32_t timeout_ms);
 
 /**
- * Disconnect from topic
+ * Disconnect from topic, descriptor is released and might be returned by subsequent connections.
+ * Outstanding loan of the descriptor is ended: write loan is committed, read loan is released. As loan keeps
+ * topic's lock taken by the loaning thread, disconnect of the descriptor holding a loan must be called by that thread
  * @param td topic descriptor
- * @return eswb_e_ok on success
+ * @return eswb_e_ok on success, eswb_e_invargs if descriptor is not connected
  */
 eswb_rv_t eswb_disconnect(eswb_topic_descr_t td);
 
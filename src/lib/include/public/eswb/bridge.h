@@ -15,6 +15,12 @@ extern "C" {
 #endif
 
 #define BRIDGE_NAME_MAX 30
+#define BRIDGE_SNAPSHOT_ATTEMPTS 16
+
+typedef enum {
+    eswb_bridge_on_any = 0,     // update destination when any of the sources is updated
+    eswb_bridge_on_all,         // update destination when every source is updated
+} eswb_bridge_trigger_t;
 
 typedef struct {
     char name[BRIDGE_NAME_MAX + 1];
@@ -24,11 +30,17 @@ typedef struct {
     eswb_size_t buffer2post_size;
 
     eswb_topic_descr_t dest_td;
+    int alias; // destination is mapped onto sources, see eswb_bridge_connect_alias
+
+    eswb_bridge_trigger_t trigger;
+    uint32_t min_interval_us;
+    uint64_t last_post_us;
 
     struct topics_subsriptions {
         eswb_topic_descr_t td;
         topic_data_type_t type;
         eswb_size_t size;
+        uint32_t version; // version of the topic's data copied by the last read
         char dest_name[ESWB_TOPIC_NAME_MAX_LEN + 1];
     } topics[0];
 
@@ -48,9 +60,54 @@ eswb_rv_t eswb_bridge_create(const char *name, eswb_size_t max_tds, eswb_bridge_
 eswb_rv_t
 eswb_bridge_add_topic(eswb_bridge_t *b, eswb_topic_descr_t mnt_td, const char *src_path, const char *dest_name);
 eswb_rv_t eswb_bridge_connect(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const char *dest_mnt);
+
+/**
+ * Same as eswb_bridge_connect, but destination is proclaimed by eswb_proclaim_alias: no buffer is allocated and
+ * nothing is copied, destination reads sources' memory under their sync. eswb_bridge_update does nothing then.
+ * @return eswb_e_invargs if sources don't lay one after another in the same structure,
+ *  eswb_e_not_supported if destination bus is synced differently from the sources' one or buses are inter process
+ */
+eswb_rv_t eswb_bridge_connect_alias(eswb_bridge_t *b, eswb_topic_descr_t mtd_td, const char *dest_mnt);
 eswb_rv_t eswb_bridge_read(eswb_bridge_t *b, void *data);
 eswb_rv_t eswb_bridge_update(eswb_bridge_t *b);
 
+/**
+ * Read all bridge's topics as a consistent cut: none of the sources was updated after its copy was taken and
+ * before the last one was taken. Sources updated in the middle are re-read, up to BRIDGE_SNAPSHOT_ATTEMPTS times.
+ * Updates done by a producer one topic after another still may be caught in the middle, put such topics into
+ * one structure to have them aligned.
+ * @param b connected bridge
+ * @param data buffer of b->buffer2post_size
+ * @return eswb_e_ok on success,
+ *  eswb_e_sync_inconsistent if sources kept changing for all attempts, data contains latest copies then
+ */
+eswb_rv_t eswb_bridge_read_snapshot(eswb_bridge_t *b, void *data);
+
+/**
+ * Same as eswb_bridge_update, but sources are read by eswb_bridge_read_snapshot, nothing is posted if it fails
+ */
+eswb_rv_t eswb_bridge_update_snapshot(eswb_bridge_t *b);
+
+/**
+ * Set condition for eswb_bridge_wait_update
+ * @param trigger eswb_bridge_on_any (default) or eswb_bridge_on_all
+ * @param min_interval_us minimal interval between destination updates, 0 for no limit
+ * @return eswb_e_ok on success
+ */
+eswb_rv_t eswb_bridge_set_trigger(eswb_bridge_t *b, eswb_bridge_trigger_t trigger, uint32_t min_interval_us);
+
+/**
+ * Block till bridge's trigger condition is met for sources updated since the last snapshot, then update destination
+ * by eswb_bridge_update_snapshot. Call it in a loop of a dedicated thread, it doesn't consume CPU while sources are idle.
+ * @param b connected bridge with sources on synchronized buses, ESWB_WAIT_ANY_MAX_TOPICS at most
+ * @param timeout_us timeout in microseconds, 0 to wait without timeout
+ * @return eswb_e_ok when destination is updated
+ *  eswb_e_timedout if condition was not met within the timeout
+ *  eswb_e_not_supported for non synced and inter process sources or too many sources
+ *  eswb_e_sync_inconsistent if snapshot failed, nothing is posted
+ */
+eswb_rv_t eswb_bridge_wait_update(eswb_bridge_t *b, uint32_t timeout_us);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,9 @@ typedef struct {
     eswb_topic_id_t topic_id;
     eswb_event_queue_mask_t ch_mask;
     event_queue_record_type_s_t type;
+    uint32_t seq;       // number of the event on its bus
+    uint64_t timestamp; // CLOCK_MONOTONIC nanoseconds of publishing, 0 if queue's timestamping is off
+    uint32_t origin_seq;// replicated events only: number of the event on its origin bus, delivered instead of seq
     void *data;
 } event_queue_record_t;
 
@@ -31,9 +34,17 @@ typedef struct  __attribute__((packed)) event_queue_transfer {
     uint32_t size;
     uint32_t topic_id;
     uint8_t  type;
+    uint32_t seq;
+    uint64_t timestamp;
  /* uint8_t  data[size]; */
 } event_queue_transfer_t;
 
+// replicated event's stamps, 0 fields are filled by the replica as for its own events
+typedef struct {
+    uint64_t timestamp;
+    uint32_t seq;
+} event_queue_origin_t;
+
 #define EVENT_QUEUE_TRANSFER_DATA(__etp) ((uint8_t*) (((uint8_t*)(__etp)) + sizeof(event_queue_transfer_t)))
 
 typedef struct {
@@ -48,8 +59,12 @@ extern "C" {
 #endif
 
 eswb_rv_t eswb_event_queue_enable(eswb_topic_descr_t td, eswb_size_t queue_size, eswb_size_t buffer_size);
+eswb_rv_t eswb_event_queue_enable_subch(eswb_topic_descr_t td, eswb_size_t queue_size, eswb_size_t buffer_size,
+                                        eswb_event_queue_mask_t subch_mask);
+eswb_rv_t eswb_event_queue_enable_conflating(eswb_topic_descr_t td, eswb_size_t slots_num, eswb_size_t buffer_size);
 eswb_rv_t eswb_event_queue_order_topic(eswb_topic_descr_t td, const char *topics_path_mask, eswb_index_t subch_ind);
 
+eswb_rv_t eswb_event_queue_set_timestamping(eswb_topic_descr_t td, int enable);
 eswb_rv_t eswb_event_queue_set_receive_mask(eswb_topic_descr_t td, eswb_event_queue_mask_t mask);
 eswb_rv_t eswb_event_queue_subscribe(const char *bus_path, eswb_topic_descr_t *td);
 
@@ -17,6 +17,10 @@
 
 #define TOPIC_FLAG_MAPPED_TO_PARENT (1UL << 0UL)
 #define TOPIC_FLAG_USES_PARENT_SYNC    (1UL << 1UL)
+#define TOPIC_FLAG_LOCKFREE_FIFO    (1UL << 2UL) // tt_fifo root only: single producer, consumers pop without locking
+#define TOPIC_FLAG_TRIPLE_BUFFER    (1UL << 3UL) // data topics only: readers copy the latest of three buffers, block writer only if it keeps overtaking them
+#define TOPIC_FLAG_CONFLATING       (1UL << 4UL) // tt_event_queue only: keeps the latest event of every topic instead of all events
+#define TOPIC_FLAG_ALIAS            (1UL << 5UL) // set by registry only: topic is mapped onto memory of a topic of another tree
 //#define TOPIC_USER_PARENT_IS_FIFO (1UL << 0UL)
 
 #define PR_TREE_NAME (ESWB_TOPIC_NAME_MAX_LEN+1)
@@ -76,7 +76,21 @@ typedef enum {
     eswb_ctl_get_topic_path,
     eswb_ctl_get_next_proclaiming_info,
     eswb_ctl_fifo_flush,
-    eswb_ctl_arm_timeout
+    eswb_ctl_arm_timeout,
+    eswb_ctl_loan_write,
+    eswb_ctl_commit,
+    eswb_ctl_borrow_read,
+    eswb_ctl_release,
+    eswb_ctl_get_topic_stats,
+    eswb_ctl_get_pollfd,
+    eswb_ctl_get_bus_stats,
+    eswb_ctl_evq_set_timestamping,
+    eswb_ctl_arm_event_origin,
+    eswb_ctl_get_version,
+    eswb_ctl_enable_counters,
+    eswb_ctl_get_topic_counters,
+    eswb_ctl_publish_stats,
+    eswb_ctl_get_wakeup_hist,
 } eswb_ctl_t;
 
 
@@ -84,6 +98,9 @@ typedef enum {
 #define ESWB_TOPIC_NAME_MAX_LEN 30
 #define ESWB_TOPIC_MAX_PATH_LEN 100
 
+#define ESWB_WAIT_ANY_MAX_TOPICS 32
+#define ESWB_ALIAS_MAX_SOURCES 32
+
 
 typedef int eswb_topic_descr_t;
 
@@ -94,6 +111,36 @@ typedef struct {
     eswb_size_t size;
 } topic_params_t;
 
+typedef struct {
+    uint32_t wakeups;           // updates which woke up blocked subscribers
+    uint32_t wakeups_skipped;   // updates which skipped broadcast as nobody was blocked
+} topic_stats_t;
+
+#define BUS_STATS_DIR_NAME ".stats"
+
+typedef struct {
+    uint32_t updates;           // updates, commits and pushes
+    uint32_t reads;             // reads, got updates, borrows and pops
+    uint32_t waits;             // blocking calls which found nothing ready and had to wait
+    uint32_t timeouts;          // blocking calls ended by timeout
+    uint32_t fifo_underruns;    // pops which found receiver overrun by the writer
+    uint64_t bytes;             // bytes written and read
+    uint64_t last_update_ns;    // CLOCK_MONOTONIC time of the last update
+} topic_counters_t;
+
+#define ESWB_WAKEUP_HIST_BUCKETS 32
+
+typedef struct {
+    // bucket i counts wakeups taken [2^i, 2^(i+1)) ns since the update, the last one counts longer ones too;
+    // filled only while bus's counters are enabled, see eswb_get_wakeup_hist
+    uint32_t buckets[ESWB_WAKEUP_HIST_BUCKETS];
+} topic_wakeup_hist_t;
+
+typedef struct {
+    uint32_t topics_num;        // topics registered in the bus, including its root
+    uint32_t mem_used;          // bytes taken by the bus registry, topics, their data and syncs
+} bus_stats_t;
+
 const char *eswb_type_name(topic_data_type_t t);
 
 #ifdef __cplusplus
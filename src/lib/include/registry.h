@@ -5,23 +5,56 @@
 #include "topic_mem.h"
 #include "eswb/topic_proclaiming_tree.h"
 
+typedef struct reg_arena {
+    uint8_t            *base;
+    eswb_size_t         size;
+    eswb_size_t         used;
+    int                 owned;      // allocated with registry and released by reg_destroy
+} reg_arena_t;
+
+#define REG_TOPICS_CHUNK_SIZE TOPIC_CHUNK_SIZE
+#define REG_TOPICS_CHUNKS_MAX 512
+#define REG_TOPICS_MAX (REG_TOPICS_CHUNK_SIZE * REG_TOPICS_CHUNKS_MAX)
+
+typedef struct reg_name_index {
+    eswb_size_t             mask;
+    struct reg_name_index  *retired;    // previous generation, kept till registry destroy as readers might still probe it
+    eswb_index_t            slots[];    // topic id + 1, zero if empty
+} reg_name_index_t;
+
 typedef struct registry {
 
-    struct sync_handle* sync;
+    struct sync_handle* sync;   // serializes registering writers, lookups and iteration go without it
     eswb_size_t         max_topics;
     eswb_index_t        topics_num;
-    topic_t             topics[0];
+    reg_arena_t         arena;      // topics, their data and syncs are allocated here instead of heap if size is nonzero
+    int                 pshared;    // registry is in memory shared between processes
+    reg_name_index_t   *name_index; // open addressing hash of (parent, name), replaced as a whole when grown
+    eswb_size_t         mem_used;   // registry's footprint: its own structures, topics, their data and syncs
+    int                 counters_enabled; // topics' counters are maintained by every process using the bus
+    topic_chunk_t      *topics[REG_TOPICS_CHUNKS_MAX]; // allocated by chunks on demand, id is index across chunks
 
 } registry_t;
 
+static inline topic_t *reg_topic(registry_t *reg, eswb_topic_id_t id) {
+    return &reg->topics[id / REG_TOPICS_CHUNK_SIZE]->hot[id % REG_TOPICS_CHUNK_SIZE];
+}
+
 
 
-eswb_rv_t reg_create(const char *root_name, registry_t **new_reg, eswb_size_t max_topics, int synced);
+eswb_rv_t reg_create(const char *root_name, registry_t **new_reg, eswb_size_t max_topics, eswb_size_t arena_size,
+                     int synced);
+eswb_rv_t reg_create_in_memory(const char *root_name, void *mem, eswb_size_t mem_size, eswb_size_t max_topics,
+                               int synced, int pshared, registry_t **new_reg);
+eswb_size_t reg_size(eswb_size_t max_topics);
 eswb_rv_t reg_destroy(registry_t *reg);
 
 eswb_rv_t reg_tree_register(registry_t *reg, topic_t *mounting_topic, topic_proclaiming_tree_t *new_topic_struct, int synced);
-topic_t *reg_find_topic(registry_t *reg, const char *path, int synced);
-eswb_rv_t reg_get_next_topic_info(registry_t *reg, topic_t *parent, eswb_topic_id_t id, topic_extract_t *extract, int synced);
+eswb_rv_t reg_tree_register_alias(registry_t *reg, topic_t *mounting_topic, topic_proclaiming_tree_t *new_topic_struct,
+                                  topic_t *alias, int synced);
+topic_t *reg_find_topic(registry_t *reg, const char *path);
+void reg_get_stats(registry_t *reg, bus_stats_t *stats);
+eswb_rv_t reg_get_next_topic_info(registry_t *reg, topic_t *parent, eswb_topic_id_t id, topic_extract_t *extract);
 
 void reg_print(registry_t *reg);
 
@@ -0,0 +1,15 @@
+#ifndef ESWB_SHM_H
+#define ESWB_SHM_H
+
+#include <stdint.h>
+#include "eswb/errors.h"
+#include "eswb/types.h"
+
+struct shm_segment;
+
+eswb_rv_t shm_segment_create(const char *name, eswb_size_t size, struct shm_segment **seg, void **mem);
+void shm_segment_publish(struct shm_segment *seg);
+eswb_rv_t shm_segment_attach(const char *name, struct shm_segment **seg, void **mem, eswb_size_t *size);
+eswb_rv_t shm_segment_release(struct shm_segment *seg, int do_unlink);
+
+#endif //ESWB_SHM_H
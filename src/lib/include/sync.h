@@ -7,6 +7,9 @@
 struct sync_handle;
 
 eswb_rv_t sync_create(struct sync_handle **s);
+uint32_t sync_handle_size(void);
+eswb_rv_t sync_init(struct sync_handle *s, int pshared);
+eswb_rv_t sync_deinit(struct sync_handle *s);
 eswb_rv_t sync_take(struct sync_handle *ps);
 eswb_rv_t sync_give(struct sync_handle *ps);
 eswb_rv_t sync_wait(struct sync_handle *ps);
@@ -0,0 +1,9 @@
+#ifndef ESWB_TIMING_H
+#define ESWB_TIMING_H
+
+#include <stdint.h>
+
+uint64_t timing_now_us(void);
+void timing_sleep_us(uint32_t us);
+
+#endif //ESWB_TIMING_H
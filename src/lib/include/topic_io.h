@@ -5,14 +5,51 @@
 #include "eswb/errors.h"
 #include "topic_mem.h"
 
+/**
+ * Wake up object shared by several topics, so a single thread can wait for any of them
+ */
+typedef struct topic_listener {
+    struct sync_handle *sync;
+    uint32_t ready_mask;
+    int event_fd; // signalled instead of the sync if not negative
+} topic_listener_t;
+
+typedef struct topic_listener_link {
+    topic_listener_t *listener;
+    uint32_t ready_bit;
+    struct topic_listener_link *next;
+} topic_listener_link_t;
+
 
 eswb_rv_t topic_io_read(topic_t *t, void *data, int synced);
 eswb_rv_t topic_io_get_update(topic_t *t, void *data, int synced, uint32_t timeout_us);
 eswb_rv_t topic_io_fifo_pop(topic_t *t, fifo_rcvr_state_t *rcvr_state, void *data, int synced, int do_wait, uint32_t timeout_us);
+eswb_rv_t topic_io_fifo_pop_n(topic_t *t, fifo_rcvr_state_t *rcvr_state, void *data, eswb_size_t max, eswb_size_t *got,
+                              int synced, int do_wait, uint32_t timeout_us);
 eswb_rv_t topic_io_fifo_flush(topic_t *t, fifo_rcvr_state_t *rcvr_state, int synced);
 eswb_rv_t topic_io_event_queue_pop(topic_t *t, eswb_event_queue_mask_t mask, fifo_rcvr_state_t *rcvr_state,
                                    event_queue_transfer_t *eqt, int synced, uint32_t timeout_us);
-eswb_rv_t topic_io_do_update(topic_t *t, eswb_update_t ut, void *data, int synced);
+eswb_rv_t topic_io_event_queue_conflated_pop(topic_t *t, eswb_event_queue_mask_t mask, fifo_rcvr_state_t *rcvr_state,
+                                             event_queue_transfer_t *eqt, int synced, uint32_t timeout_us);
+eswb_rv_t topic_io_event_subqueue_pop(topic_t *evq, topic_t *subq, fifo_rcvr_state_t *rcvr_state,
+                                      event_queue_transfer_t *eqt, int synced, uint32_t timeout_us);
+eswb_rv_t topic_io_do_update(topic_t *t, eswb_update_t ut, void *data, eswb_size_t elem_num, int synced);
+eswb_rv_t topic_io_proclaim_alias(topic_t *t, topic_proclaiming_tree_t *tree, topic_t *alias, int synced);
 eswb_rv_t topic_io_get_state (topic_t *t, topic_fifo_state_t *state, int synced);
+eswb_rv_t topic_io_loan_write(topic_t *t, void **data, int synced);
+eswb_rv_t topic_io_commit(topic_t *t, int synced);
+eswb_rv_t topic_io_borrow_read(topic_t *t, void **data, int synced);
+eswb_rv_t topic_io_release(topic_t *t, int synced);
+void topic_io_get_stats(topic_t *t, topic_stats_t *stats);
+void topic_io_get_wakeup_hist(topic_t *t, topic_wakeup_hist_t *hist);
+
+eswb_rv_t topic_io_listener_init(topic_listener_t *l);
+eswb_rv_t topic_io_listener_init_pollfd(topic_listener_t *l);
+void topic_io_listener_deinit(topic_listener_t *l);
+void topic_io_listener_signal(topic_listener_t *l, uint32_t ready_bit);
+eswb_rv_t topic_io_listener_wait(topic_listener_t *l, uint32_t pending_mask, uint32_t timeout_us, uint32_t *ready_mask);
+void topic_io_listener_attach(topic_t *t, topic_listener_link_t *link);
+void topic_io_listener_detach(topic_t *t, topic_listener_link_t *link);
+int topic_io_fifo_pending(topic_t *t, const fifo_rcvr_state_t *rcvr_state);
 
 #endif //ESWB_TOPIC_IO_H
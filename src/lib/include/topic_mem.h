@@ -8,6 +8,7 @@
 #include "sync.h"
 
 struct registry;
+struct topic_listener_link;
 
 
 typedef struct topic_state {
@@ -15,7 +16,7 @@ typedef struct topic_state {
     eswb_fifo_index_t    head; // TODO actually points to a place where next push will be stored, rename it? or change convention
     eswb_fifo_index_t    lap_num;
 
-} topic_fifo_state_t;
+} __attribute__((aligned(4))) topic_fifo_state_t; // aligned to be loaded and stored atomically as a whole
 
 
 typedef struct fifo_ext {
@@ -23,39 +24,89 @@ typedef struct fifo_ext {
     eswb_size_t         elem_step;
     eswb_size_t         elem_size;
     topic_fifo_state_t  state;
+    eswb_size_t         evq_data_live; // event queue only: newest records whose data is not overwritten yet
+    eswb_event_queue_mask_t evq_subch_mask; // event queue only: channels having own sub-queue
+    uint32_t            evq_seq;        // event queue only: sequence number of the last event
+    uint32_t            evq_timestamping; // event queue only: events are stamped with time of publishing
+    eswb_index_t        evq_slots_used; // conflating event queue only: slots taken, each one holds its data region
+    eswb_size_t         evq_data_used;  // conflating event queue only: buffer taken by slots' data
+    eswb_index_t        evq_oldest;     // conflating event queue only: slots list in order of their events
+    eswb_index_t        evq_newest;
 
 } fifo_ext_t;
 
 #define TOPIC_FLAGS_TO_EVENT_QUEUE (1 << 0)
 
-typedef struct topic {
-    // credentials
-    char name[ESWB_TOPIC_NAME_MAX_LEN + 1];
-    topic_data_type_t type;
-    char* annotation;
-    eswb_size_t data_size; // field size for regular topic; length of fifo for fifo; overall size for event_queue
+#define TOPIC_CHUNK_SIZE 64
+#define TOPIC_CACHE_LINE 64
 
+/*
+ * Hot part of the topic: everything touched by read and update paths, fits a single cache line.
+ * Topics are allocated by chunks, so name and navigation live in the chunk's cold table at the same index.
+ */
+typedef struct topic {
     void* data;
     fifo_ext_t *fifo_ext;
-    // sync and stat
     struct sync_handle* sync;
+    struct topic *sync_owner; // topic owning the sync and data, the topic itself unless mapped to parent or using its sync
+
+    eswb_size_t data_size; // field size for regular topic; length of fifo for fifo; overall size for event_queue
+    uint32_t seq; // seqlock counter of sync_owner's data, odd while write is in progress
+    uint32_t waiters; // number of threads blocked on sync_owner's sync, including attached listeners
+    eswb_topic_id_t id;
+    eswb_event_queue_mask_t evq_mask; // TODO this thing should be inherited by nested topics
+    topic_stats_t stats;
 
-    //state : state
-    //last_update_time : time
-    //eswb_index_t me;
+    uint16_t flags;
+    topic_data_type_s_t type;
 
-    uint32_t flags;
+} __attribute__((aligned(TOPIC_CACHE_LINE))) topic_t;
+
+#ifndef __cplusplus
+_Static_assert(sizeof(topic_t) == TOPIC_CACHE_LINE, "hot part of the topic must fit a cache line");
+#endif
+
+/*
+ * Cold part of the topic: credentials and tree navigation, used by registration, lookup and listing
+ */
+typedef struct topic_node {
+    char name[ESWB_TOPIC_NAME_MAX_LEN + 1];
+    char* annotation;
 
-    // navigating
     struct topic *parent;
     struct topic *first_child;
     struct topic *next_sibling;
 
     struct registry *reg_ref;
-    eswb_topic_id_t    id;
-
-    eswb_event_queue_mask_t evq_mask; // TODO this thing should be inherited by nested topics
-} topic_t;
+    struct topic_listener_link *listeners; // multi-topic waiters attached to sync_owner, only walked on wakeup
+    eswb_index_t evq_slot; // slot of topic's latest event in bus's conflating event queue
+    topic_counters_t counters; // maintained only while counters are enabled for the bus
+    topic_wakeup_hist_t wakeup_hist; // same as counters
+    uint64_t wake_ns; // sync owner only: time blocked subscribers were woken up at, while counters are enabled
+} topic_node_t;
+
+/*
+ * Conflating event queue keeps only the latest event of every topic: fifo elements are slots, a topic takes
+ * a slot with its first event and every next event overwrites it and moves it to the end of the slots list.
+ * Slots are referred by index + 1, zero means none.
+ */
+typedef struct event_queue_slot {
+    event_queue_record_t rec; // seq of records is ascending along the list
+    eswb_size_t capacity;   // size of data region taken from the buffer
+    eswb_index_t prev;
+    eswb_index_t next;
+} event_queue_slot_t;
+
+typedef struct topic_chunk {
+    topic_t         hot[TOPIC_CHUNK_SIZE]; // must be the first member, topic_node finds the chunk by it
+    topic_node_t    cold[TOPIC_CHUNK_SIZE];
+} topic_chunk_t;
+
+static inline topic_node_t *topic_node(const topic_t *t) {
+    eswb_index_t i = t->id % TOPIC_CHUNK_SIZE;
+    topic_chunk_t *chunk = (topic_chunk_t *) (t - i);
+    return &chunk->cold[i];
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,9 +114,17 @@ extern "C" {
 
 
 eswb_rv_t topic_mem_write(topic_t *t, void *data);
+void *topic_mem_write_begin(topic_t *t);
+void topic_mem_write_end(topic_t *t);
+void *topic_mem_write_buffer(topic_t *t);
+eswb_size_t topic_mem_tb_stride(topic_t *t);
 eswb_rv_t topic_mem_simply_copy(topic_t *t, void *data);
-eswb_rv_t topic_mem_write_fifo(topic_t *t, void *data);
+eswb_rv_t topic_mem_read_consistent(topic_t *t, void *data);
+uint32_t topic_mem_version(topic_t *t);
+eswb_rv_t topic_mem_write_fifo(topic_t *t, void *data, eswb_size_t num);
 void topic_mem_read_fifo(topic_t *t, eswb_index_t tail, void *data);
+void topic_mem_read_fifo_n(topic_t *t, eswb_index_t tail, void *data, eswb_size_t num);
+void topic_mem_fifo_get_state(topic_t *t, topic_fifo_state_t *state);
 eswb_rv_t topic_mem_get_params(topic_t *t, topic_params_t *params);
 
 typedef eswb_rv_t (*crawling_lambda_t)(void *d, topic_t *t);
@@ -74,6 +133,9 @@ eswb_rv_t topic_mem_walk_through(topic_t *root, const char *find_path, crawling_
 
 eswb_rv_t topic_mem_event_queue_write(topic_t *t, const event_queue_record_t *r);
 
+topic_t *topic_mem_event_queue_subch(topic_t *evq, eswb_event_queue_mask_t mask);
+event_queue_slot_t *topic_mem_event_queue_slot(topic_t *evq, eswb_index_t ref);
+eswb_index_t topic_mem_event_queue_next_slot(topic_t *evq, eswb_index_t cursor, uint32_t seq);
 eswb_rv_t topic_mem_event_queue_get_data(topic_t *evq, event_queue_record_t *event, void *data);
 void topic_event_queue_read(topic_t *t, eswb_index_t tail, event_queue_record_t *r);
 
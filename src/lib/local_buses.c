@@ -1,4 +1,6 @@
 #include <string.h>
+#include <stdlib.h>
+#include <time.h>
 
 #include "eswb/errors.h"
 #include "registry.h"
@@ -7,14 +9,34 @@
 #include "eswb/event_queue.h"
 
 #include "topic_io.h"
+#include "shm.h"
 
-#define ITB_TD_MAX 512
+// descriptors table grows by chunks, so entries never move and might be accessed without locking
+#define LOCAL_TD_CHUNK_SIZE 128
+#define LOCAL_TD_CHUNKS_MAX 512
+#define LOCAL_TD_MAX (LOCAL_TD_CHUNK_SIZE * LOCAL_TD_CHUNKS_MAX)
 
 #define LOCAL_INDEX_INIT 1
 
-static topic_local_index_t local_td_index[ITB_TD_MAX];
+static topic_local_index_t *local_td_chunks[LOCAL_TD_CHUNKS_MAX];
 static int local_index_num = LOCAL_INDEX_INIT; // omit first for having no zero td-s
 
+// released descriptors stack: lower half is td on top (0 if empty), upper half is a tag against ABA
+static uint64_t local_td_free_head;
+
+static inline topic_local_index_t *local_td(eswb_topic_descr_t td) {
+    return &local_td_chunks[td / LOCAL_TD_CHUNK_SIZE][td % LOCAL_TD_CHUNK_SIZE];
+}
+
+static int local_td_num(void) {
+    int n = __atomic_load_n(&local_index_num, __ATOMIC_ACQUIRE);
+    return n < LOCAL_TD_MAX ? n : LOCAL_TD_MAX;
+}
+
+static int local_td_is_mapped(eswb_topic_descr_t td) {
+    return __atomic_load_n(&local_td_chunks[td / LOCAL_TD_CHUNK_SIZE], __ATOMIC_ACQUIRE) != NULL;
+}
+
 #include <pthread.h>
 static pthread_mutex_t local_topic_index_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t local_buses_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -22,6 +44,11 @@ static pthread_mutex_t local_buses_mutex = PTHREAD_MUTEX_INITIALIZER;
 #define LOCAL_BUSSES_MAX 16
 static eswb_bus_handle_t local_buses[LOCAL_BUSSES_MAX];
 
+static void local_release_pollfd(topic_local_index_t *li);
+static eswb_rv_t local_commit(topic_local_index_t *li);
+static eswb_rv_t local_release(topic_local_index_t *li);
+static eswb_rv_t local_connect_event_queue(eswb_bus_handle_t *bh, eswb_topic_descr_t *td);
+
 int local_bus_is_inited(const eswb_bus_handle_t *b){
     return b->registry != NULL;
 }
@@ -31,15 +58,30 @@ eswb_rv_t local_buses_init(int do_reset) {
 
     if (do_reset) {
         // TODO sync protection
+        for (int i = LOCAL_INDEX_INIT; i < local_td_num(); i++) {
+            if (local_td_is_mapped(i)) {
+                local_release_pollfd(local_td(i));
+            }
+        }
+
         for (int i = 0; i < LOCAL_BUSSES_MAX; i++) {
-            if (local_bus_is_inited(&local_buses[i]))
+            if (local_bus_is_inited(&local_buses[i])) {
                 reg_destroy(local_buses[i].registry);
+                free(local_buses[i].stats_tds);
+                if (local_buses[i].shm != NULL) {
+                    shm_segment_release(local_buses[i].shm, local_buses[i].shm_owner);
+                }
+            }
         }
 
         memset(local_buses, 0, sizeof(local_buses));
         // drop connections
-        memset(local_td_index, 0, sizeof(local_td_index));
+        for (int i = 0; i < LOCAL_TD_CHUNKS_MAX; i++) {
+            free(local_td_chunks[i]);
+            local_td_chunks[i] = NULL;
+        }
         local_index_num = LOCAL_INDEX_INIT;
+        local_td_free_head = 0;
     }
 
     pthread_mutex_unlock(&local_buses_mutex);
@@ -48,12 +90,7 @@ eswb_rv_t local_buses_init(int do_reset) {
 }
 
 
-eswb_rv_t local_bus_lookup(const char *bus_name, local_bus_type_t type, eswb_bus_handle_t **b) {
-    // TODO local bus sync protection and platform independability
-
-    eswb_rv_t rv = eswb_e_bus_not_exist;
-    pthread_mutex_lock(&local_buses_mutex);
-
+static eswb_rv_t local_bus_lookup_nolock(const char *bus_name, local_bus_type_t type, eswb_bus_handle_t **b) {
     for (int i = 0; i < LOCAL_BUSSES_MAX; i++) {
         if (local_bus_is_inited(&local_buses[i])) {
             if (((type == local_bus_t_synced_or_nonsynced) || (local_buses[i].local_type == type)) &&
@@ -61,12 +98,29 @@ eswb_rv_t local_bus_lookup(const char *bus_name, local_bus_type_t type, eswb_bus
                 if (b != NULL) {
                     *b = &local_buses[i];
                 }
-                rv = eswb_e_ok;
-                break;
+                return eswb_e_ok;
             }
         }
     }
 
+    return eswb_e_bus_not_exist;
+}
+
+static eswb_bus_handle_t *local_bus_free_handle_nolock(void) {
+    for (int i = 0; i < LOCAL_BUSSES_MAX; i++) {
+        if (!local_bus_is_inited(&local_buses[i])) {
+            return &local_buses[i];
+        }
+    }
+
+    return NULL;
+}
+
+eswb_rv_t local_bus_lookup(const char *bus_name, local_bus_type_t type, eswb_bus_handle_t **b) {
+    // TODO local bus sync protection and platform independability
+
+    pthread_mutex_lock(&local_buses_mutex);
+    eswb_rv_t rv = local_bus_lookup_nolock(bus_name, type, b);
     pthread_mutex_unlock(&local_buses_mutex);
 
     return rv;
@@ -86,22 +140,33 @@ eswb_rv_t local_lookup_any(const char *bus_name, eswb_bus_handle_t **b) {
 }
 
 static int bus_is_synced(eswb_bus_handle_t *bh) {
-    return bh->local_type == local_bus_t_synced ? -1 : 0;
+    return bh->local_type != local_bus_t_nonsynced ? -1 : 0;
+}
+
+static int bus_is_interprocess(eswb_bus_handle_t *bh) {
+    return bh->local_type == local_bus_t_interprocess ? -1 : 0;
 }
 
 #define TOPIC_IS_FIFO(__t) (((__t)->type == tt_fifo) || ((__t)->type == tt_event_queue))
 
+/**
+ * FIFO the receiver pops from: event queue consumer of a single channel reads its sub-queue
+ */
+static topic_t *rcvr_fifo(topic_local_index_t *li) {
+    return li->event_subqueue != NULL ? li->event_subqueue : li->t;
+}
+
 eswb_rv_t local_bus_connect(eswb_bus_handle_t *bh, const char *conn_pnt, eswb_topic_descr_t *td) {
     eswb_topic_descr_t new_td;
-    topic_t *t = reg_find_topic(bh->registry, conn_pnt, bus_is_synced(bh));
+    topic_t *t = reg_find_topic(bh->registry, conn_pnt);
             //bh->drv->find_topic((registry_t *)bh->registry, conn_pnt, &t);
     if (t == NULL) {
         return eswb_e_no_topic;
     }
 
-    if ((t->parent != NULL) &&
-            TOPIC_IS_FIFO(t->parent)) {
-        t = t->parent;
+    if ((topic_node(t)->parent != NULL) &&
+            TOPIC_IS_FIFO(topic_node(t)->parent)) {
+        t = topic_node(t)->parent;
     }
 
     eswb_rv_t rv = local_bus_alloc_topic_descr(bh, t, &new_td);
@@ -124,10 +189,10 @@ eswb_rv_t local_bus_connect(eswb_bus_handle_t *bh, const char *conn_pnt, eswb_to
 //#include <stdio.h>
 
 const topic_t *local_bus_topics_list(eswb_topic_descr_t td) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
 //    printf("%s\n", li->bh->registry->topics[0].name);
 
-    return &li->bh->registry->topics[0];
+    return reg_topic(li->bh->registry, 0);
 }
 
 int local_buses_num() {
@@ -143,7 +208,8 @@ int local_buses_num() {
     return rv;
 }
 
-eswb_rv_t local_bus_create(const char *bus_name, local_bus_type_t type, eswb_size_t max_topics) {
+static eswb_rv_t local_bus_create_with_arena(const char *bus_name, local_bus_type_t type, eswb_size_t max_topics,
+                                             eswb_size_t arena_size) {
 
     // TODO platform independability
     eswb_rv_t rv;
@@ -157,14 +223,7 @@ eswb_rv_t local_bus_create(const char *bus_name, local_bus_type_t type, eswb_siz
 
     pthread_mutex_lock(&local_buses_mutex);
     do {
-        eswb_bus_handle_t *new = NULL;
-
-        for (int i = 0; i < LOCAL_BUSSES_MAX; i++) {
-            if (!local_bus_is_inited(&local_buses[i])) {
-                new = &local_buses[i];
-                break;
-            }
-        }
+        eswb_bus_handle_t *new = local_bus_free_handle_nolock();
 
         if (new == NULL) {
             rv = eswb_e_max_busses_reached;
@@ -172,22 +231,32 @@ eswb_rv_t local_bus_create(const char *bus_name, local_bus_type_t type, eswb_siz
         }
         strncpy(new->name, bus_name, ESWB_BUS_NAME_MAX_LEN);
         new->local_type = type;
-        rv = reg_create(bus_name, &new->registry, max_topics, type == local_bus_t_synced ? -1 : 0);
+        rv = reg_create(bus_name, &new->registry, max_topics, arena_size, type == local_bus_t_synced ? -1 : 0);
     } while(0);
     pthread_mutex_unlock(&local_buses_mutex);
 
     return rv;
 }
 
+eswb_rv_t local_bus_create(const char *bus_name, local_bus_type_t type, eswb_size_t max_topics) {
+    return local_bus_create_with_arena(bus_name, type, max_topics, 0);
+}
+
 eswb_rv_t local_bus_delete(eswb_bus_handle_t *bh) {
 
     pthread_mutex_lock(&local_topic_index_mutex);
 
     // making related TDs invalid
-    for (int i = LOCAL_INDEX_INIT; i < local_index_num; i++) {
-        if (local_td_index[i].bh == bh) {
-            local_td_index[i].t = NULL;
-            local_td_index[i].bh = NULL;
+    for (int i = LOCAL_INDEX_INIT; i < local_td_num(); i++) {
+        if (!local_td_is_mapped(i)) {
+            continue;
+        }
+        topic_local_index_t *li = local_td(i);
+        if (li->bh == bh) {
+            local_release_pollfd(li);
+            li->t = NULL;
+            li->bh = NULL;
+            li->loan_state = loan_none; // topic is gone along with its sync
         }
     }
 
@@ -195,47 +264,242 @@ eswb_rv_t local_bus_delete(eswb_bus_handle_t *bh) {
 
     pthread_mutex_lock(&local_buses_mutex);
     reg_destroy(bh->registry);
+    free(bh->stats_tds);
+    if (bh->shm != NULL) {
+        // deletion by any process removes the bus, processes already attached to it keep their mappings
+        shm_segment_release(bh->shm, -1);
+    }
     memset(bh, 0, sizeof(*bh));
     pthread_mutex_unlock(&local_buses_mutex);
 
     return eswb_e_ok;
 }
 
-eswb_rv_t local_bus_itb_create(const char *bus_name, eswb_size_t max_topics) {
-    return local_bus_create(bus_name, local_bus_t_synced, max_topics);
+eswb_rv_t local_bus_itb_create(const char *bus_name, eswb_size_t max_topics, eswb_size_t arena_size) {
+    return local_bus_create_with_arena(bus_name, local_bus_t_synced, max_topics, arena_size);
 }
 
-eswb_rv_t local_bus_nsb_create(const char *bus_name, eswb_size_t max_topics) {
-    return local_bus_create(bus_name, local_bus_t_nonsynced, max_topics);
+eswb_rv_t local_bus_nsb_create(const char *bus_name, eswb_size_t max_topics, eswb_size_t arena_size) {
+    return local_bus_create_with_arena(bus_name, local_bus_t_nonsynced, max_topics, arena_size);
 }
 
-eswb_rv_t  local_bus_alloc_topic_descr(eswb_bus_handle_t *bh, topic_t *t, eswb_topic_descr_t *td) {
+// topics' data and syncs of an interprocess bus are reserved with this average size per topic unless arena size is set
+#define IPB_SEGMENT_DATA_PER_TOPIC 4096
+
+eswb_rv_t local_bus_ipb_create(const char *bus_name, eswb_size_t max_topics, eswb_size_t arena_size) {
     eswb_rv_t rv;
+    struct shm_segment *seg;
+    void *mem;
 
-    pthread_mutex_lock(&local_topic_index_mutex); // TODO portable sync
+    if (strlen(bus_name) >= ESWB_BUS_NAME_MAX_LEN) {
+        return eswb_e_invargs;
+    }
 
+    pthread_mutex_lock(&local_buses_mutex);
     do {
+        if (local_bus_lookup_nolock(bus_name, local_bus_t_interprocess, NULL) == eswb_e_ok) {
+            rv = eswb_e_bus_exists;
+            break;
+        }
 
-        if (local_index_num >= ITB_TD_MAX) {
-            rv = eswb_e_max_topic_desrcs;
+        eswb_bus_handle_t *new = local_bus_free_handle_nolock();
+        if (new == NULL) {
+            rv = eswb_e_max_busses_reached;
             break;
         }
 
-        topic_local_index_t *li = &local_td_index[local_index_num];
+        eswb_size_t mem_size = arena_size > 0 ? arena_size :
+                               reg_size(max_topics) + max_topics * IPB_SEGMENT_DATA_PER_TOPIC;
 
-        li->t = t;
-        li->bh = bh;
+        rv = shm_segment_create(bus_name, mem_size, &seg, &mem);
+        if (rv != eswb_e_ok) {
+            break;
+        }
+
+        rv = reg_create_in_memory(bus_name, mem, mem_size, max_topics, -1, -1, &new->registry);
+        if (rv != eswb_e_ok) {
+            new->registry = NULL;
+            shm_segment_release(seg, -1);
+            break;
+        }
 
-        *td = local_index_num;
-        local_index_num++;
-        rv = eswb_e_ok;
-    } while (0);
+        shm_segment_publish(seg);
 
-    pthread_mutex_unlock(&local_topic_index_mutex);
+        strncpy(new->name, bus_name, ESWB_BUS_NAME_MAX_LEN);
+        new->local_type = local_bus_t_interprocess;
+        new->shm = seg;
+        new->shm_owner = -1;
+    } while(0);
+    pthread_mutex_unlock(&local_buses_mutex);
 
     return rv;
 }
 
+/**
+ * Lookup interprocess bus attached to this process, or attach it if it is created by another one
+ */
+eswb_rv_t local_lookup_ipb(const char *bus_name, eswb_bus_handle_t **b) {
+    eswb_rv_t rv;
+    eswb_bus_handle_t *bh = NULL;
+    int attached = 0;
+
+    pthread_mutex_lock(&local_buses_mutex);
+    do {
+        rv = local_bus_lookup_nolock(bus_name, local_bus_t_interprocess, &bh);
+        if (rv == eswb_e_ok) {
+            break;
+        }
+
+        bh = local_bus_free_handle_nolock();
+        if (bh == NULL) {
+            rv = eswb_e_max_busses_reached;
+            break;
+        }
+
+        struct shm_segment *seg;
+        void *mem;
+        eswb_size_t mem_size;
+
+        rv = shm_segment_attach(bus_name, &seg, &mem, &mem_size);
+        if (rv != eswb_e_ok) {
+            break;
+        }
+
+        strncpy(bh->name, bus_name, ESWB_BUS_NAME_MAX_LEN);
+        bh->local_type = local_bus_t_interprocess;
+        bh->registry = mem;
+        bh->shm = seg;
+        bh->shm_owner = 0;
+        attached = -1;
+    } while(0);
+    pthread_mutex_unlock(&local_buses_mutex);
+
+    if (rv != eswb_e_ok) {
+        return rv;
+    }
+
+    if (attached) {
+        // event queue publisher is process local, reconnect if the bus has one
+        eswb_topic_descr_t td;
+        if (local_connect_event_queue(bh, &td) == eswb_e_ok) {
+            pthread_mutex_lock(&local_buses_mutex);
+            bh->event_queue_publisher_td = td;
+            pthread_mutex_unlock(&local_buses_mutex);
+        }
+    }
+
+    if (b != NULL) {
+        *b = bh;
+    }
+
+    return eswb_e_ok;
+}
+
+static eswb_topic_descr_t local_td_pop_free(void) {
+    uint64_t head = __atomic_load_n(&local_td_free_head, __ATOMIC_ACQUIRE);
+    uint64_t next;
+
+    do {
+        eswb_topic_descr_t td = (eswb_topic_descr_t) (head & 0xFFFFFFFF);
+        if (td == 0) {
+            return 0;
+        }
+        // entry might be popped and reused concurrently, then tag is changed and CAS fails
+        eswb_topic_descr_t next_td = __atomic_load_n(&local_td(td)->next_free, __ATOMIC_RELAXED);
+        next = ((head >> 32) + 1) << 32 | (uint32_t) next_td;
+    } while (!__atomic_compare_exchange_n(&local_td_free_head, &head, next, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    return (eswb_topic_descr_t) (head & 0xFFFFFFFF);
+}
+
+static void local_td_push_free(eswb_topic_descr_t td) {
+    uint64_t head = __atomic_load_n(&local_td_free_head, __ATOMIC_RELAXED);
+    uint64_t next;
+
+    do {
+        __atomic_store_n(&local_td(td)->next_free, (eswb_topic_descr_t) (head & 0xFFFFFFFF), __ATOMIC_RELAXED);
+        next = ((head >> 32) + 1) << 32 | (uint32_t) td;
+    } while (!__atomic_compare_exchange_n(&local_td_free_head, &head, next, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static eswb_topic_descr_t local_td_grow(void) {
+    eswb_topic_descr_t td = __atomic_fetch_add(&local_index_num, 1, __ATOMIC_ACQ_REL);
+    if (td >= LOCAL_TD_MAX) {
+        return 0;
+    }
+
+    topic_local_index_t **chunk = &local_td_chunks[td / LOCAL_TD_CHUNK_SIZE];
+    if (__atomic_load_n(chunk, __ATOMIC_ACQUIRE) == NULL) {
+        topic_local_index_t *new_chunk = calloc(LOCAL_TD_CHUNK_SIZE, sizeof(*new_chunk));
+        if (new_chunk == NULL) {
+            return 0;
+        }
+
+        topic_local_index_t *expected = NULL;
+        if (!__atomic_compare_exchange_n(chunk, &expected, new_chunk, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            // somebody has got a descriptor from the same chunk and mapped it first
+            free(new_chunk);
+        }
+    }
+
+    return td;
+}
+
+eswb_rv_t  local_bus_alloc_topic_descr(eswb_bus_handle_t *bh, topic_t *t, eswb_topic_descr_t *td) {
+    eswb_topic_descr_t new_td = local_td_pop_free();
+    if (new_td == 0) {
+        new_td = local_td_grow();
+        if (new_td == 0) {
+            return eswb_e_max_topic_desrcs;
+        }
+    }
+
+    topic_local_index_t *li = local_td(new_td);
+    memset(li, 0, sizeof(*li));
+    li->t = t;
+    li->bh = bh;
+    __atomic_store_n(&li->allocated, 1, __ATOMIC_RELEASE);
+
+    *td = new_td;
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t local_disconnect(eswb_topic_descr_t td) {
+    if ((td < LOCAL_INDEX_INIT) || (td >= local_td_num()) || !local_td_is_mapped(td)) {
+        return eswb_e_invargs;
+    }
+
+    topic_local_index_t *li = local_td(td);
+
+    // only one of concurrent disconnects gets the descriptor back to the table
+    int allocated = 1;
+    if (!__atomic_compare_exchange_n(&li->allocated, &allocated, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return eswb_e_invargs;
+    }
+
+    // outstanding loan keeps the topic locked, nobody could end it after the descriptor is gone;
+    // topic is NULL if the bus was deleted
+    if (li->t != NULL) {
+        if (li->loan_state == loan_write) {
+            local_commit(li);
+        } else if (li->loan_state == loan_read) {
+            local_release(li);
+        }
+    }
+    li->loan_state = loan_none;
+
+    pthread_mutex_lock(&local_topic_index_mutex);
+    local_release_pollfd(li);
+    li->t = NULL;
+    li->bh = NULL;
+    pthread_mutex_unlock(&local_topic_index_mutex);
+
+    local_td_push_free(td);
+
+    return eswb_e_ok;
+}
+
 
 #include <stdio.h>
 
@@ -265,9 +529,80 @@ static event_queue_record_type_t event_type (eswb_update_t ut) {
 }
 
 eswb_rv_t local_event_queue_update(eswb_bus_handle_t *bh, event_queue_record_t *record) {
-    topic_local_index_t *eq_li = &local_td_index[bh->event_queue_publisher_td];
+    topic_local_index_t *eq_li = local_td(bh->event_queue_publisher_td);
+
+    return topic_io_do_update(eq_li->t, upd_push_event_queue, record, 1, bus_is_synced(bh));
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Time of publishing is taken before event queue is locked, so waiting for the lock counts in the latency
+ */
+static uint64_t event_queue_timestamp(topic_local_index_t *li, topic_t *evq) {
+    if (li->event_origin.timestamp != 0) {
+        return li->event_origin.timestamp;
+    }
+
+    if (!__atomic_load_n(&evq->fifo_ext->evq_timestamping, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+
+    return monotonic_ns();
+}
+
+static int counters_enabled(topic_local_index_t *li) {
+    return __atomic_load_n(&li->bh->registry->counters_enabled, __ATOMIC_RELAXED);
+}
+
+/**
+ * Counters are shared by all threads and processes accessing the topic, relaxed increments are enough for them
+ * @param is_update successful call counts as update, otherwise as read
+ * @param bytes moved by successful call
+ */
+static void counters_account(topic_local_index_t *li, eswb_rv_t rv, int is_update, eswb_size_t bytes) {
+    topic_counters_t *c = &topic_node(li->t)->counters;
+
+    switch (rv) {
+        case eswb_e_ok:
+            __atomic_fetch_add(is_update ? &c->updates : &c->reads, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&c->bytes, bytes, __ATOMIC_RELAXED);
+            if (is_update) {
+                __atomic_store_n(&c->last_update_ns, monotonic_ns(), __ATOMIC_RELAXED);
+            }
+            break;
+
+        case eswb_e_timedout:
+            __atomic_fetch_add(&c->timeouts, 1, __ATOMIC_RELAXED);
+            break;
+
+        case eswb_e_fifo_rcvr_underrun:
+            __atomic_fetch_add(&c->fifo_underruns, 1, __ATOMIC_RELAXED);
+            break;
 
-    return topic_io_do_update(eq_li->t, upd_push_event_queue, record, bus_is_synced(bh));
+        default:
+            break;
+    }
+}
+
+static void counters_account_wait(topic_local_index_t *li) {
+    __atomic_fetch_add(&topic_node(li->t)->counters.waits, 1, __ATOMIC_RELAXED);
+}
+
+static void counters_load(topic_t *t, topic_counters_t *dst) {
+    topic_counters_t *c = &topic_node(t)->counters;
+
+    dst->updates = __atomic_load_n(&c->updates, __ATOMIC_RELAXED);
+    dst->reads = __atomic_load_n(&c->reads, __ATOMIC_RELAXED);
+    dst->waits = __atomic_load_n(&c->waits, __ATOMIC_RELAXED);
+    dst->timeouts = __atomic_load_n(&c->timeouts, __ATOMIC_RELAXED);
+    dst->fifo_underruns = __atomic_load_n(&c->fifo_underruns, __ATOMIC_RELAXED);
+    dst->bytes = __atomic_load_n(&c->bytes, __ATOMIC_RELAXED);
+    dst->last_update_ns = __atomic_load_n(&c->last_update_ns, __ATOMIC_RELAXED);
 }
 
 static eswb_rv_t local_event_queue_pack_and_update(topic_local_index_t *li, eswb_update_t ut, void *data, eswb_size_t elem_num) {
@@ -286,6 +621,8 @@ static eswb_rv_t local_event_queue_pack_and_update(topic_local_index_t *li, eswb
             .topic_id = li->t->id,
             .ch_mask = li->t->evq_mask,
             .type = et,
+            .timestamp = event_queue_timestamp(li, local_td(li->bh->event_queue_publisher_td)->t),
+            .origin_seq = li->event_origin.seq,
             .data = data
     };
 
@@ -298,78 +635,327 @@ static eswb_rv_t local_event_queue_pack_and_update(topic_local_index_t *li, eswb
 }
 
 eswb_rv_t local_do_update(eswb_topic_descr_t td, eswb_update_t ut, void *data, eswb_size_t elem_num) {
-    topic_local_index_t *li = &local_td_index[td];
-    eswb_rv_t rv = topic_io_do_update(li->t, ut, data, bus_is_synced(li->bh));
+    topic_local_index_t *li = local_td(td);
+    eswb_rv_t rv = topic_io_do_update(li->t, ut, data, elem_num, bus_is_synced(li->bh));
+
+    if ((ut != upd_proclaim_topic) && counters_enabled(li)) {
+        counters_account(li, rv, -1, ut == upd_push_fifo ? li->t->fifo_ext->elem_size * (elem_num > 0 ? elem_num : 1) :
+                                     ut == upd_update_topic ? li->t->data_size : 0);
+    }
 
     if (rv == eswb_e_ok) {
         if (li->t->evq_mask) {
-            local_event_queue_pack_and_update(li, ut, data, elem_num);
+            if ((ut == upd_push_fifo) && (elem_num > 1)) {
+                // every pushed element goes to event queue as a separate event
+                for (eswb_size_t i = 0; i < elem_num; i++) {
+                    local_event_queue_pack_and_update(li, ut, data + li->t->fifo_ext->elem_size * i, 1);
+                }
+            } else {
+                local_event_queue_pack_and_update(li, ut, data, elem_num);
+            }
             // TODO handle rv
         }
     }
+    memset(&li->event_origin, 0, sizeof(li->event_origin));
 
     return rv;
 }
 
+eswb_rv_t local_proclaim_alias(eswb_topic_descr_t mnt_td, const eswb_topic_descr_t *src_tds, int src_num,
+                               topic_proclaiming_tree_t *tree) {
+    topic_local_index_t *li = local_td(mnt_td);
+    eswb_size_t size = 0;
+    topic_t *first = NULL;
+
+    for (int i = 0; i < src_num; i++) {
+        topic_local_index_t *sli = local_td(src_tds[i]);
+        if ((li->t == NULL) || (sli->t == NULL)) {
+            return eswb_e_invargs;
+        }
+        // syncs are shared, so both buses must be synced the same way and be reachable by raw pointers
+        if ((bus_is_synced(li->bh) != bus_is_synced(sli->bh)) ||
+            bus_is_interprocess(li->bh) || bus_is_interprocess(sli->bh)) {
+            return eswb_e_not_supported;
+        }
+        // sources must lay one after another in the memory of the same sync owner
+        if (first == NULL) {
+            first = sli->t;
+        } else if ((sli->t->sync_owner != first->sync_owner) || (sli->t->data != first->data + size)) {
+            return eswb_e_invargs;
+        }
+        size += sli->t->data_size;
+    }
+
+    if ((first == NULL) || (tree->data_size != size)) {
+        return eswb_e_invargs;
+    }
+
+    return topic_io_proclaim_alias(li->t, tree, first, bus_is_synced(li->bh));
+}
+
+static eswb_rv_t local_loan_write(topic_local_index_t *li, void **data) {
+    if (li->loan_state != loan_none) {
+        return eswb_e_invargs;
+    }
+
+    eswb_rv_t rv = topic_io_loan_write(li->t, data, bus_is_synced(li->bh));
+    if (rv == eswb_e_ok) {
+        li->loan_state = loan_write;
+    }
+
+    return rv;
+}
+
+static eswb_rv_t local_commit(topic_local_index_t *li) {
+    if (li->loan_state != loan_write) {
+        return eswb_e_invargs;
+    }
+
+    // event is packed while topic is still locked, so the published snapshot matches the committed data
+    if (li->t->evq_mask) {
+        local_event_queue_pack_and_update(li, upd_update_topic, topic_mem_write_buffer(li->t), 0);
+    }
+    memset(&li->event_origin, 0, sizeof(li->event_origin));
+
+    li->loan_state = loan_none;
+
+    eswb_rv_t rv = topic_io_commit(li->t, bus_is_synced(li->bh));
+    if (counters_enabled(li)) {
+        counters_account(li, rv, -1, li->t->data_size);
+    }
+
+    return rv;
+}
+
+static eswb_rv_t local_borrow_read(topic_local_index_t *li, void **data) {
+    if (li->loan_state != loan_none) {
+        return eswb_e_invargs;
+    }
+
+    eswb_rv_t rv = topic_io_borrow_read(li->t, data, bus_is_synced(li->bh));
+    if (rv == eswb_e_ok) {
+        li->loan_state = loan_read;
+    }
+    if (counters_enabled(li)) {
+        counters_account(li, rv, 0, li->t->data_size);
+    }
+
+    return rv;
+}
+
+static eswb_rv_t local_release(topic_local_index_t *li) {
+    if (li->loan_state != loan_read) {
+        return eswb_e_invargs;
+    }
+
+    li->loan_state = loan_none;
+
+    return topic_io_release(li->t, bus_is_synced(li->bh));
+}
+
 eswb_rv_t local_do_read(eswb_topic_descr_t td, void *data) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
 
-    return topic_io_read(li->t, data, bus_is_synced(li->bh));
+    eswb_rv_t rv = topic_io_read(li->t, data, bus_is_synced(li->bh));
+    if (counters_enabled(li)) {
+        counters_account(li, rv, 0, li->t->data_size);
+    }
+
+    return rv;
 }
 
 eswb_rv_t local_get_update(eswb_topic_descr_t td, void *data) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
+    int counting = counters_enabled(li);
+
+    if (counting) {
+        // update is always waited for
+        counters_account_wait(li);
+    }
 
     eswb_rv_t rv = topic_io_get_update(li->t, data, bus_is_synced(li->bh), li->timeout_us);
     li->timeout_us = 0;
 
+    if (counting) {
+        counters_account(li, rv, 0, li->t->data_size);
+    }
+
     return rv;
 }
 
 eswb_rv_t local_get_params(eswb_topic_descr_t td, topic_params_t *params) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
     // don't need to be sync proteced, data is read only for registered topics
 
     return topic_mem_get_params(li->t, params);
 }
 
+eswb_rv_t local_get_stats(eswb_topic_descr_t td, topic_stats_t *stats) {
+    topic_local_index_t *li = local_td(td);
+
+    topic_io_get_stats(li->t, stats);
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t local_wait_any(const eswb_topic_descr_t *tds, int n, const uint32_t *versions, uint32_t timeout_us,
+                         uint32_t *ready_mask) {
+    topic_listener_t listener;
+    topic_listener_link_t links[ESWB_WAIT_ANY_MAX_TOPICS];
+    uint32_t pending_mask = 0;
+
+    for (int i = 0; i < n; i++) {
+        topic_local_index_t *li = local_td(tds[i]);
+        if (li->t == NULL) {
+            return eswb_e_invargs;
+        }
+        // listeners are process local, so they can't be attached to topics in shared memory
+        if (!bus_is_synced(li->bh) || bus_is_interprocess(li->bh)) {
+            return eswb_e_not_supported;
+        }
+    }
+
+    eswb_rv_t rv = topic_io_listener_init(&listener);
+    if (rv != eswb_e_ok) {
+        return rv;
+    }
+
+    for (int i = 0; i < n; i++) {
+        topic_local_index_t *li = local_td(tds[i]);
+
+        links[i].listener = &listener;
+        links[i].ready_bit = 1UL << i;
+        topic_io_listener_attach(li->t, &links[i]);
+
+        // FIFOs are ready while there is something to pop, other topics only on the next update
+        if (TOPIC_IS_FIFO(li->t) && topic_io_fifo_pending(rcvr_fifo(li), &li->rcvr_state)) {
+            pending_mask |= links[i].ready_bit;
+        }
+        // updates done before attaching are seen by the version
+        if ((versions != NULL) && (topic_mem_version(li->t) != versions[i])) {
+            pending_mask |= links[i].ready_bit;
+        }
+    }
+
+    rv = topic_io_listener_wait(&listener, pending_mask, timeout_us, ready_mask);
+
+    for (int i = 0; i < n; i++) {
+        topic_io_listener_detach(local_td(tds[i])->t, &links[i]);
+    }
+
+    topic_io_listener_deinit(&listener);
+
+    return rv;
+}
+
+typedef struct topic_local_pollfd {
+    topic_listener_t listener;
+    topic_listener_link_t link;
+} topic_local_pollfd_t;
+
+static eswb_rv_t local_get_pollfd(topic_local_index_t *li, int *fd) {
+    if (!bus_is_synced(li->bh) || bus_is_interprocess(li->bh)) {
+        return eswb_e_not_supported;
+    }
+
+    if (li->pollfd == NULL) {
+        topic_local_pollfd_t *p = calloc(1, sizeof(*p));
+        if (p == NULL) {
+            return eswb_e_mem_sync_na;
+        }
+
+        eswb_rv_t rv = topic_io_listener_init_pollfd(&p->listener);
+        if (rv != eswb_e_ok) {
+            free(p);
+            return rv;
+        }
+
+        p->link.listener = &p->listener;
+        p->link.ready_bit = 1;
+        topic_io_listener_attach(li->t, &p->link);
+
+        // same as for eswb_wait_any, FIFO is ready while there is something to pop
+        if (TOPIC_IS_FIFO(li->t) && topic_io_fifo_pending(rcvr_fifo(li), &li->rcvr_state)) {
+            topic_io_listener_signal(&p->listener, p->link.ready_bit);
+        }
+
+        li->pollfd = p;
+    }
+
+    *fd = li->pollfd->listener.event_fd;
+
+    return eswb_e_ok;
+}
+
+static void local_release_pollfd(topic_local_index_t *li) {
+    if (li->pollfd == NULL) {
+        return;
+    }
+
+    topic_io_listener_detach(li->t, &li->pollfd->link);
+    topic_io_listener_deinit(&li->pollfd->listener);
+    free(li->pollfd);
+    li->pollfd = NULL;
+}
+
 eswb_rv_t local_arm_timeout(topic_local_index_t *li, uint32_t timeout_us) {
     li->timeout_us = timeout_us;
     return eswb_e_ok;
 }
 
 eswb_rv_t local_get_mounting_point(eswb_topic_descr_t td, char *mp) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
     // don't need to be sync proteced, data is read only for registered topics
 
-    strncpy(mp, li->bh->local_type == local_bus_t_synced ? "itb:" : "nsb:", ESWB_TOPIC_MAX_PATH_LEN);
+    const char *prefix;
+    switch (li->bh->local_type) {
+        case local_bus_t_synced:        prefix = "itb:"; break;
+        case local_bus_t_interprocess:  prefix = "ipb:"; break;
+        default:                        prefix = "nsb:"; break;
+    }
+    strncpy(mp, prefix, ESWB_TOPIC_MAX_PATH_LEN);
 
     int depth = 0;
-    for (topic_t *n = li->t; n != NULL; n = n->parent) {
+    for (topic_t *n = li->t; n != NULL; n = topic_node(n)->parent) {
         depth++;
     }
 
     for (int i = 0; i < depth; i++) {
         topic_t *t = li->t;
         for(int j = 0; j < depth - 1 - i; j++) {
-            t = t->parent;
+            t = topic_node(t)->parent;
         }
         strncat(mp, "/", ESWB_TOPIC_MAX_PATH_LEN - strlen(mp));
-        strncat(mp, t->name, ESWB_TOPIC_MAX_PATH_LEN - strlen(mp));
+        strncat(mp, topic_node(t)->name, ESWB_TOPIC_MAX_PATH_LEN - strlen(mp));
     }
 
     return eswb_e_ok;
 }
 
 eswb_rv_t local_fifo_pop(eswb_topic_descr_t td, void *data, int do_wait) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
+    int counting = counters_enabled(li) && TOPIC_IS_FIFO(li->t);
 
     eswb_rv_t rv;
 
+    // event queues are always popped in blocking manner
+    if (counting && (do_wait || (li->t->type == tt_event_queue)) &&
+        !topic_io_fifo_pending(rcvr_fifo(li), &li->rcvr_state)) {
+        counters_account_wait(li);
+    }
+
     switch(li->t->type) {
         case tt_event_queue:
-            rv = topic_io_event_queue_pop(li->t, li->event_queue_mask, &li->rcvr_state, data, bus_is_synced(li->bh),
-                                            li->timeout_us);
+            if (li->t->flags & TOPIC_FLAG_CONFLATING) {
+                rv = topic_io_event_queue_conflated_pop(li->t, li->event_queue_mask, &li->rcvr_state, data,
+                                                        bus_is_synced(li->bh), li->timeout_us);
+            } else if (li->event_subqueue != NULL) {
+                rv = topic_io_event_subqueue_pop(li->t, li->event_subqueue, &li->rcvr_state, data,
+                                                 bus_is_synced(li->bh), li->timeout_us);
+            } else {
+                rv = topic_io_event_queue_pop(li->t, li->event_queue_mask, &li->rcvr_state, data,
+                                              bus_is_synced(li->bh), li->timeout_us);
+            }
             break;
 
         case tt_fifo:
@@ -382,20 +968,63 @@ eswb_rv_t local_fifo_pop(eswb_topic_descr_t td, void *data, int do_wait) {
             break;
     }
 
+    if (counting) {
+        eswb_size_t bytes = 0;
+        if (rv == eswb_e_ok) {
+            bytes = li->t->type == tt_event_queue ? ((event_queue_transfer_t *) data)->size : li->t->fifo_ext->elem_size;
+        }
+        counters_account(li, rv, 0, bytes);
+    }
+
+    li->timeout_us = 0;
+    return rv;
+}
+
+eswb_rv_t local_fifo_pop_n(eswb_topic_descr_t td, void *data, eswb_size_t max, eswb_size_t *got, int do_wait) {
+    topic_local_index_t *li = local_td(td);
+    int counting = counters_enabled(li);
+
+    eswb_rv_t rv;
+
+    switch(li->t->type) {
+        case tt_fifo:
+            if (counting && do_wait && !topic_io_fifo_pending(li->t, &li->rcvr_state)) {
+                counters_account_wait(li);
+            }
+            rv = topic_io_fifo_pop_n(li->t, &li->rcvr_state, data, max, got,
+                                     bus_is_synced(li->bh), do_wait, li->timeout_us);
+            if (counting) {
+                counters_account(li, rv, 0, li->t->fifo_ext->elem_size * (rv == eswb_e_ok ? *got : 0));
+            }
+            break;
+
+        case tt_event_queue:
+            rv = eswb_e_not_supported;
+            break;
+
+        default:
+            rv = eswb_e_not_fifo;
+            break;
+    }
+
     li->timeout_us = 0;
     return rv;
 }
 
 eswb_rv_t local_fifo_flush(topic_local_index_t *li) {
-    return topic_io_fifo_flush(li->t, &li->rcvr_state, bus_is_synced(li->bh));
+    return topic_io_fifo_flush(rcvr_fifo(li), &li->rcvr_state, bus_is_synced(li->bh));
 }
 
 eswb_rv_t local_init_fifo_receiver(eswb_topic_descr_t td) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
+
+    if (li->t->flags & TOPIC_FLAG_CONFLATING) {
+        return local_fifo_flush(li);
+    }
 
     topic_fifo_state_t s;
 
-    eswb_rv_t rv = topic_io_get_state(li->t, &s, bus_is_synced(li->bh));
+    eswb_rv_t rv = topic_io_get_state(rcvr_fifo(li), &s, bus_is_synced(li->bh));
     if (rv == eswb_e_ok) {
         li->rcvr_state.tail = s.head; // TODO maybe we need already accumulated but not overwritten data?
         li->rcvr_state.lap = s.lap_num;
@@ -404,33 +1033,63 @@ eswb_rv_t local_init_fifo_receiver(eswb_topic_descr_t td) {
     return rv;
 }
 
-eswb_rv_t local_bus_create_event_queue(eswb_bus_handle_t *bh, eswb_size_t events_num, eswb_size_t data_buf_size) {
+static eswb_rv_t local_connect_event_queue(eswb_bus_handle_t *bh, eswb_topic_descr_t *td) {
+    // TODO This is lame, must be removed in overall connectivity refactoring
+    char full_path[ESWB_TOPIC_NAME_MAX_LEN+1];
+    strcpy(full_path, bh->name );
+    strcat(full_path, "/");
+    strcat(full_path, BUS_EVENT_QUEUE_NAME);
+
+    return local_bus_connect(bh, full_path, td);
+}
+
+/**
+ * @param subch_mask channels getting own sub-queue, so their consumers don't skip events of other channels
+ * @param conflating keep the latest event of every topic only, events_num is the number of slots for them
+ */
+eswb_rv_t local_bus_create_event_queue(eswb_bus_handle_t *bh, eswb_size_t events_num, eswb_size_t data_buf_size,
+                                       eswb_event_queue_mask_t subch_mask, int conflating) {
     eswb_topic_descr_t td;
+    char subch_name[ESWB_TOPIC_NAME_MAX_LEN + 1];
 
-    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 3);
+    if (conflating && subch_mask) {
+        return eswb_e_invargs;
+    }
+
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 3 + 2 * __builtin_popcount(subch_mask));
     topic_proclaiming_tree_t *r = usr_topic_set_root(cntx, BUS_EVENT_QUEUE_NAME, tt_event_queue, events_num);
+    r->flags = conflating ? TOPIC_FLAG_CONFLATING : 0;
     // fifo convention: it's element must be first child
-    usr_topic_add_child(cntx, r, "event", tt_struct, 0, sizeof(event_queue_record_t), TOPIC_FLAG_MAPPED_TO_PARENT);
+    usr_topic_add_child(cntx, r, "event", tt_struct, 0,
+                        conflating ? sizeof(event_queue_slot_t) : sizeof(event_queue_record_t),
+                        TOPIC_FLAG_MAPPED_TO_PARENT);
     usr_topic_add_child(cntx, r, "data_buf", tt_byte_buffer, 0, data_buf_size, TOPIC_FLAG_USES_PARENT_SYNC);
 
+    // sub-queues go after the buffer in channels order, they are pushed under the event queue's sync
+    for (int ch = 0; ch < 32; ch++) {
+        if (subch_mask & (1UL << ch)) {
+            snprintf(subch_name, sizeof(subch_name), "subch%d", ch);
+            topic_proclaiming_tree_t *sq = usr_topic_add_child(cntx, r, subch_name, tt_fifo, 0, events_num,
+                                                               TOPIC_FLAG_USES_PARENT_SYNC);
+            usr_topic_add_child(cntx, sq, "pos", tt_struct, 0, sizeof(topic_fifo_state_t), TOPIC_FLAG_MAPPED_TO_PARENT);
+        }
+    }
+
 
-    eswb_rv_t rv = topic_io_do_update(&bh->registry->topics[0], upd_proclaim_topic, r, bus_is_synced(bh));
+    eswb_rv_t rv = topic_io_do_update(reg_topic(bh->registry, 0), upd_proclaim_topic, r, cntx->t_num, bus_is_synced(bh));
 
     if (rv != eswb_e_ok) {
         return rv;
     }
 
-    // TODO This is lame, must be removed in overall connectivity refactoring
-    char full_path[ESWB_TOPIC_NAME_MAX_LEN+1];
-    strcpy(full_path, bh->name );
-    strcat(full_path, "/");
-    strcat(full_path, BUS_EVENT_QUEUE_NAME);
-
-    rv = local_bus_connect(bh, full_path, &td);
+    rv = local_connect_event_queue(bh, &td);
     if (rv != eswb_e_ok) {
         return rv;
     }
 
+    // nobody publishes to the queue yet
+    local_td(td)->t->fifo_ext->evq_subch_mask = subch_mask;
+
     // TODO fix this bad pattern:
     pthread_mutex_lock(&local_buses_mutex); // TODO portable sync, rethink where to sync it? or whould we at all?
     bh->event_queue_publisher_td = td;
@@ -439,6 +1098,119 @@ eswb_rv_t local_bus_create_event_queue(eswb_bus_handle_t *bh, eswb_size_t events
     return eswb_e_ok;
 }
 
+/**
+ * Proclaim tree under topic of the path unless it exists (e.g. proclaimed by the other process) and connect to it
+ */
+static eswb_rv_t stats_proclaim_and_connect(eswb_bus_handle_t *bh, const char *parent_path,
+                                            topic_proclaiming_tree_t *r, eswb_size_t tree_size, eswb_topic_descr_t *td) {
+    char path[ESWB_TOPIC_MAX_PATH_LEN + 1];
+    eswb_topic_descr_t parent_td;
+
+    // registry doesn't reject duplicate names, so reuse topic proclaimed by another handle of the bus
+    snprintf(path, sizeof(path), "%s/%s", parent_path, r->name);
+    eswb_rv_t rv = local_bus_connect(bh, path, td);
+    if (rv != eswb_e_no_topic) {
+        return rv;
+    }
+
+    rv = local_bus_connect(bh, parent_path, &parent_td);
+    if (rv != eswb_e_ok) {
+        return rv;
+    }
+
+    // goes through the regular update, so event queue replicates it
+    rv = local_do_update(parent_td, upd_proclaim_topic, r, tree_size);
+    local_disconnect(parent_td);
+    if (rv != eswb_e_ok) {
+        return rv;
+    }
+
+    return local_bus_connect(bh, path, td);
+}
+
+static eswb_rv_t stats_topic_connect(eswb_bus_handle_t *bh, eswb_topic_id_t id, eswb_topic_descr_t *td) {
+    char parent_path[ESWB_TOPIC_MAX_PATH_LEN + 1];
+    char name[ESWB_TOPIC_NAME_MAX_LEN + 1];
+    topic_counters_t c;
+
+    snprintf(parent_path, sizeof(parent_path), "%s/%s", bh->name, BUS_STATS_DIR_NAME);
+    snprintf(name, sizeof(name), "%u", (unsigned) id);
+
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 8);
+    topic_proclaiming_tree_t *r = usr_topic_set_struct(cntx, c, name);
+    usr_topic_add_struct_child(cntx, r, topic_counters_t, updates, "updates", tt_uint32);
+    usr_topic_add_struct_child(cntx, r, topic_counters_t, reads, "reads", tt_uint32);
+    usr_topic_add_struct_child(cntx, r, topic_counters_t, waits, "waits", tt_uint32);
+    usr_topic_add_struct_child(cntx, r, topic_counters_t, timeouts, "timeouts", tt_uint32);
+    usr_topic_add_struct_child(cntx, r, topic_counters_t, fifo_underruns, "fifo_underruns", tt_uint32);
+    usr_topic_add_struct_child(cntx, r, topic_counters_t, bytes, "bytes", tt_uint64);
+    usr_topic_add_struct_child(cntx, r, topic_counters_t, last_update_ns, "last_update_ns", tt_uint64);
+
+    return stats_proclaim_and_connect(bh, parent_path, r, cntx->t_num, td);
+}
+
+static int stats_topic_is_own(topic_t *t, topic_t *stats_dir) {
+    // statistics subtree is two levels deep: topics named by ids and their fields
+    topic_t *p = topic_node(t)->parent;
+    return (t == stats_dir) || (p == stats_dir) || ((p != NULL) && (topic_node(p)->parent == stats_dir));
+}
+
+/**
+ * Publish counters of every active topic of the bus into BUS_STATS_DIR_NAME subtree, topic of counters is named
+ * by id of the topic it describes and is proclaimed by the first publish after the topic got active.
+ * Must not be called concurrently for the same bus.
+ */
+static eswb_rv_t local_publish_stats(eswb_bus_handle_t *bh) {
+    registry_t *reg = bh->registry;
+    topic_counters_t c;
+    eswb_rv_t rv;
+
+    if (bh->stats_tds == NULL) {
+        bh->stats_tds = calloc(reg->max_topics, sizeof(*bh->stats_tds));
+        if (bh->stats_tds == NULL) {
+            return eswb_e_mem_data_na;
+        }
+    }
+
+    if (bh->stats_dir_td == 0) {
+        TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 1);
+        topic_proclaiming_tree_t *r = usr_topic_set_root(cntx, BUS_STATS_DIR_NAME, tt_dir, 0);
+        rv = stats_proclaim_and_connect(bh, bh->name, r, cntx->t_num, &bh->stats_dir_td);
+        if (rv != eswb_e_ok) {
+            return rv;
+        }
+    }
+
+    topic_t *stats_dir = local_td(bh->stats_dir_td)->t;
+    eswb_index_t topics_num = __atomic_load_n(&reg->topics_num, __ATOMIC_ACQUIRE);
+
+    for (eswb_topic_id_t id = 0; id < topics_num; id++) {
+        topic_t *t = reg_topic(reg, id);
+        if (stats_topic_is_own(t, stats_dir)) {
+            continue;
+        }
+
+        counters_load(t, &c);
+        if ((c.updates | c.reads | c.waits | c.timeouts | c.fifo_underruns) == 0) {
+            // idle topics don't take the bus's topics
+            continue;
+        }
+
+        if (bh->stats_tds[id] == 0) {
+            rv = stats_topic_connect(bh, id, &bh->stats_tds[id]);
+            if (rv != eswb_e_ok) {
+                return rv;
+            }
+        }
+
+        rv = local_do_update(bh->stats_tds[id], upd_update_topic, &c, 0);
+        if (rv != eswb_e_ok) {
+            return rv;
+        }
+    }
+
+    return eswb_e_ok;
+}
 
 static eswb_rv_t flags_attach_lambda(void *d, topic_t *t) {
     // TODO it is not thread safe, must lock on appropriate registry lock level
@@ -457,7 +1229,7 @@ static eswb_rv_t flags_attach_lambda(void *d, topic_t *t) {
 }
 
 eswb_rv_t local_bus_mark_for_event_queue(eswb_topic_descr_t td, char *path_mask, eswb_index_t ch_id) {
-    topic_local_index_t *li = &local_td_index[td];
+    topic_local_index_t *li = local_td(td);
 
     if (ch_id > 31) {
         return eswb_e_invargs;
@@ -470,11 +1242,11 @@ eswb_rv_t local_bus_get_next_topic_info(topic_local_index_t *li, eswb_topic_id_t
     if (tid == 0) {
         tid = li->t->id;
     }
-    return reg_get_next_topic_info(li->bh->registry, li->t, tid, info, bus_is_synced(li->bh));
+    return reg_get_next_topic_info(li->bh->registry, li->t, tid, info);
 }
 
 eswb_rv_t local_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int size) {
-    topic_local_index_t *li = &local_td_index[td]; // TODO make all consequent calls use this struct insted of creating own
+    topic_local_index_t *li = local_td(td); // TODO make all consequent calls use this struct insted of creating own
     eswb_bus_handle_t *bh = li->bh;
 
     switch (ctl_type) {
@@ -482,7 +1254,9 @@ eswb_rv_t local_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int siz
             ;
             eswb_size_t *params;
             params = ((eswb_size_t *) d);
-            return local_bus_create_event_queue(bh, params[0], params[1]);
+            return local_bus_create_event_queue(bh, params[0], params[1],
+                                                size >= 3 * sizeof(eswb_size_t) ? params[2] : 0,
+                                                size >= 4 * sizeof(eswb_size_t) ? params[3] : 0);
 
         case eswb_ctl_request_topics_to_evq:
             ;
@@ -497,11 +1271,27 @@ eswb_rv_t local_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int siz
             }
             // TODO lock registry?
             li->event_queue_mask = mask;
+            topic_t *subq = topic_mem_event_queue_subch(li->t, mask);
+            if (subq != li->event_subqueue) {
+                // receiver switches to the other fifo, events start from the current position there
+                li->event_subqueue = subq;
+                return local_init_fifo_receiver(td);
+            }
             return eswb_e_ok;
 
         case eswb_ctl_evq_get_params:
             return local_get_params(td, (topic_params_t *)d);
 
+        case eswb_ctl_get_pollfd:
+            return local_get_pollfd(li, (int *) d);
+
+        case eswb_ctl_get_topic_stats:
+            return local_get_stats(td, (topic_stats_t *)d);
+
+        case eswb_ctl_get_bus_stats:
+            reg_get_stats(bh->registry, (bus_stats_t *) d);
+            return eswb_e_ok;
+
         case eswb_ctl_get_topic_path:
             return local_get_mounting_point(td, (char *)d);
 
@@ -514,6 +1304,49 @@ eswb_rv_t local_ctl(eswb_topic_descr_t td, eswb_ctl_t ctl_type, void *d, int siz
         case eswb_ctl_arm_timeout:
             return local_arm_timeout(li, *((uint32_t *)d));
 
+        case eswb_ctl_enable_counters:
+            __atomic_store_n(&bh->registry->counters_enabled, *((int *) d) ? 1 : 0, __ATOMIC_RELAXED);
+            return eswb_e_ok;
+
+        case eswb_ctl_get_topic_counters:
+            counters_load(li->t, (topic_counters_t *) d);
+            return eswb_e_ok;
+
+        case eswb_ctl_publish_stats:
+            return local_publish_stats(bh);
+
+        case eswb_ctl_get_wakeup_hist:
+            topic_io_get_wakeup_hist(li->t, (topic_wakeup_hist_t *) d);
+            return eswb_e_ok;
+
+        case eswb_ctl_get_version:
+            *((uint32_t *) d) = topic_mem_version(li->t);
+            return eswb_e_ok;
+
+        case eswb_ctl_arm_event_origin:
+            li->event_origin = *((event_queue_origin_t *) d);
+            return eswb_e_ok;
+
+        case eswb_ctl_evq_set_timestamping:
+            if (bh->event_queue_publisher_td == 0) {
+                return eswb_e_ev_queue_not_enabled;
+            }
+            __atomic_store_n(&local_td(bh->event_queue_publisher_td)->t->fifo_ext->evq_timestamping,
+                             *((int *) d) ? 1 : 0, __ATOMIC_RELAXED);
+            return eswb_e_ok;
+
+        case eswb_ctl_loan_write:
+            return local_loan_write(li, (void **) d);
+
+        case eswb_ctl_commit:
+            return local_commit(li);
+
+        case eswb_ctl_borrow_read:
+            return local_borrow_read(li, (void **) d);
+
+        case eswb_ctl_release:
+            return local_release(li);
+
         default:
             return eswb_e_not_supported;
     }
@@ -0,0 +1,198 @@
+#include <stdlib.h> // for calloc
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "eswb/errors.h"
+#include "eswb/types.h"
+#include "sync.h"
+
+/*
+ * Linux specific backend: mutex and condition are raw futex words.
+ * lock states: 0 - free, 1 - taken, 2 - taken and there might be threads sleeping on it
+ */
+
+typedef struct sync_handle {
+    uint32_t lock;
+    uint32_t cond_seq; // incremented by every broadcast, waiters sleep on it
+    uint32_t waiters;  // number of threads inside sync_wait / sync_wait_timed
+    int private_flag;  // FUTEX_PRIVATE_FLAG unless the handle is shared between processes
+    int last_err;
+} futex_sync_t;
+
+static long futex(uint32_t *uaddr, int op, uint32_t val, const struct timespec *ts, uint32_t *uaddr2, uint32_t val3) {
+    return syscall(SYS_futex, uaddr, op, val, ts, uaddr2, val3);
+}
+
+uint32_t sync_handle_size(void) {
+    return sizeof(futex_sync_t);
+}
+
+/**
+ * Init sync in caller's memory
+ * @param pshared if nonzero, memory is shared between processes, so private futex ops can't be used
+ */
+eswb_rv_t sync_init(futex_sync_t *fs, int pshared) {
+    memset(fs, 0, sizeof(*fs));
+    fs->private_flag = pshared ? 0 : FUTEX_PRIVATE_FLAG;
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t sync_deinit(futex_sync_t *fs) {
+    return eswb_e_ok;
+}
+
+eswb_rv_t sync_create(futex_sync_t **s){
+
+    futex_sync_t *fs;
+
+    // TODO remove calloc
+    fs = calloc(1, sizeof(*fs));
+    if (fs == NULL) {
+        return eswb_e_mem_sync_na;
+    }
+
+    sync_init(fs, 0);
+
+    *s = fs;
+
+    return eswb_e_ok;
+}
+
+static void lock_contended(futex_sync_t *fs) {
+    // mark lock as contended, so the owner will wake us up on give
+    while (__atomic_exchange_n(&fs->lock, 2, __ATOMIC_ACQUIRE) != 0) {
+        futex(&fs->lock, FUTEX_WAIT | fs->private_flag, 2, NULL, NULL, 0);
+    }
+}
+
+eswb_rv_t sync_take(futex_sync_t *fs){
+    uint32_t c = 0;
+
+    if (!__atomic_compare_exchange_n(&fs->lock, &c, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        lock_contended(fs);
+    }
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t sync_give(futex_sync_t *fs){
+    if (__atomic_exchange_n(&fs->lock, 0, __ATOMIC_RELEASE) == 2) {
+        if (futex(&fs->lock, FUTEX_WAKE | fs->private_flag, 1, NULL, NULL, 0) < 0) {
+            fs->last_err = errno;
+            return eswb_e_sync_give;
+        }
+    }
+
+    return eswb_e_ok;
+}
+
+static void cond_wait_cancel_cleanup(void *arg) {
+    futex_sync_t *fs = arg;
+
+    // same as pthread_cond_wait: cancelled waiter leaves with the lock taken
+    __atomic_fetch_sub(&fs->waiters, 1, __ATOMIC_RELAXED);
+    lock_contended(fs);
+}
+
+static eswb_rv_t cond_wait(futex_sync_t *fs, const struct timespec *rel_timeout) {
+    uint32_t seq = __atomic_load_n(&fs->cond_seq, __ATOMIC_RELAXED);
+
+    // counted under the lock, so broadcaster never misses us
+    __atomic_fetch_add(&fs->waiters, 1, __ATOMIC_RELAXED);
+    sync_give(fs);
+
+    // raw futex syscall is not a cancellation point, so allow cancelling while sleeping like pthread_cond_wait does
+    int old_cancel_type;
+    long frv;
+    int err;
+
+    pthread_cleanup_push(cond_wait_cancel_cleanup, fs);
+    pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &old_cancel_type);
+    frv = futex(&fs->cond_seq, FUTEX_WAIT | fs->private_flag, seq, rel_timeout, NULL, 0);
+    err = errno;
+    pthread_setcanceltype(old_cancel_type, NULL);
+    pthread_cleanup_pop(0);
+
+    eswb_rv_t rv = eswb_e_ok;
+    if (frv < 0) {
+        switch (err) {
+            case ETIMEDOUT:
+                // timeout might expire after broadcast requeued us to the lock, it is not a timeout then
+                if (__atomic_load_n(&fs->cond_seq, __ATOMIC_RELAXED) == seq) {
+                    rv = eswb_e_timedout;
+                }
+                break;
+
+            case EAGAIN: // broadcast happened before we went to sleep
+            case EINTR:  // spurious wake up, same as for pthread_cond_wait
+                break;
+
+            default:
+                fs->last_err = err;
+                rv = eswb_e_sync_wait;
+                break;
+        }
+    }
+
+    __atomic_fetch_sub(&fs->waiters, 1, __ATOMIC_RELAXED);
+
+    // we might have been requeued to the lock by broadcast, so take it as contended
+    lock_contended(fs);
+
+    return rv;
+}
+
+eswb_rv_t sync_wait(futex_sync_t *fs){
+    return cond_wait(fs, NULL);
+}
+
+eswb_rv_t sync_wait_timed(futex_sync_t *fs, uint32_t timeout_us) {
+#   define USEC_IN_SEC 1000000
+
+    struct timespec ts = {
+        .tv_sec = timeout_us / USEC_IN_SEC,
+        .tv_nsec = (timeout_us % USEC_IN_SEC) * 1000
+    };
+
+    return cond_wait(fs, &ts);
+}
+
+/**
+ * Must be called with the lock taken. Wakes one waiter and requeues the rest to the lock instead of waking all of them
+ * just to make them fight for it. No syscall at all if there are no waiters.
+ */
+eswb_rv_t sync_broadcast(futex_sync_t *fs){
+    uint32_t seq = __atomic_add_fetch(&fs->cond_seq, 1, __ATOMIC_RELAXED);
+
+    if (__atomic_load_n(&fs->waiters, __ATOMIC_RELAXED) == 0) {
+        return eswb_e_ok;
+    }
+
+    // requeued waiters will be woken by sync_give
+    __atomic_store_n(&fs->lock, 2, __ATOMIC_RELAXED);
+
+    if (futex(&fs->cond_seq, FUTEX_CMP_REQUEUE | fs->private_flag, 1, (const struct timespec *) (long) INT_MAX,
+              &fs->lock, seq) < 0) {
+        fs->last_err = errno;
+        return eswb_e_sync_broadcast;
+    }
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t sync_destroy(futex_sync_t *fs){
+    free(fs);
+
+    return eswb_e_ok;
+}
+
+const char *sync_last_strerror(futex_sync_t *fs){
+    return strerror(fs->last_err);
+}
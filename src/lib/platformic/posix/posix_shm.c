@@ -0,0 +1,208 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "eswb/errors.h"
+#include "eswb/types.h"
+#include "shm.h"
+
+#define SHM_SEGMENT_MAGIC 0x45535742 // "ESWB"
+#define SHM_SEGMENT_HEADER_SIZE 64
+#define SHM_SEGMENT_NAME_MAX_LEN (ESWB_BUS_NAME_MAX_LEN + 8)
+
+/*
+ * Segment is full of raw pointers, so it is mapped at the same address in every process. Creator places it
+ * inside a fixed window, which is far below the area where ASLR puts libraries, stacks and anonymous mappings
+ * and far above the heap, so the address is likely free in an attaching process, including a freshly exec'd one.
+ * Starting slot is picked by the segment name, so buses created by different processes don't land on the same
+ * address. Without the window (32-bit or the window is not mappable) the kernel picks the address.
+ */
+#if UINTPTR_MAX > 0xFFFFFFFFUL
+#   define SHM_WINDOW_BASE     0x200000000000UL
+#   define SHM_WINDOW_SLOT     0x100000000UL    // 4 GiB
+#   define SHM_WINDOW_SLOTS    8192             // 32 TiB window
+#   define SHM_WINDOW_PROBES   64
+#endif
+
+typedef struct shm_segment {
+    uint32_t    magic;  // set by the creator when segment content is ready to be used
+    eswb_size_t size;   // whole segment size including header
+    void        *base;  // address of the segment in every process, see SHM_WINDOW_BASE
+    char        name[SHM_SEGMENT_NAME_MAX_LEN + 1];
+} shm_segment_t;
+
+_Static_assert(sizeof(shm_segment_t) <= SHM_SEGMENT_HEADER_SIZE, "shm segment header does not fit");
+
+static void shm_name(const char *name, char *shm_name) {
+    snprintf(shm_name, SHM_SEGMENT_NAME_MAX_LEN + 1, "/eswb.%s", name);
+}
+
+static void *shm_map_in_window(const char *name, eswb_size_t size, int fd) {
+#ifdef SHM_WINDOW_BASE
+    uint32_t h = 2166136261u; // FNV-1a
+    for (const char *c = name; *c != 0; c++) {
+        h = (h ^ (uint8_t) *c) * 16777619u;
+    }
+
+    eswb_size_t slots = (size + SHM_WINDOW_SLOT - 1) / SHM_WINDOW_SLOT;
+    int flags = MAP_SHARED;
+#ifdef MAP_FIXED_NOREPLACE
+    flags |= MAP_FIXED_NOREPLACE;
+#endif
+
+    for (int i = 0; i < SHM_WINDOW_PROBES; i++) {
+        uintptr_t slot = ((uintptr_t) h + (uintptr_t) i * slots) % (SHM_WINDOW_SLOTS - slots + 1);
+        void *addr = (void *) (SHM_WINDOW_BASE + slot * SHM_WINDOW_SLOT);
+
+        void *p = mmap(addr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if (p == addr) {
+            return p;
+        }
+        if (p != MAP_FAILED) {
+            // kernel without MAP_FIXED_NOREPLACE took it as a hint
+            munmap(p, size);
+        } else if (errno != EEXIST) {
+            break;
+        }
+    }
+#endif
+    return mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+}
+
+/**
+ * Create named shared memory segment and map it
+ * @param size size of memory available for the caller
+ * @param mem memory for the caller, aligned by SHM_SEGMENT_HEADER_SIZE
+ * @return eswb_e_bus_exists if segment with such name exists
+ */
+eswb_rv_t shm_segment_create(const char *name, eswb_size_t size, shm_segment_t **seg, void **mem) {
+    char sn[SHM_SEGMENT_NAME_MAX_LEN + 1];
+    shm_name(name, sn);
+
+    int fd = shm_open(sn, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+        return errno == EEXIST ? eswb_e_bus_exists : eswb_e_mem_reg_na;
+    }
+
+    eswb_size_t seg_size = size + SHM_SEGMENT_HEADER_SIZE;
+    void *base = MAP_FAILED;
+
+    if (ftruncate(fd, seg_size) == 0) {
+        base = shm_map_in_window(sn, seg_size, fd);
+    }
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        shm_unlink(sn);
+        return eswb_e_mem_reg_na;
+    }
+
+    shm_segment_t *s = base;
+    s->size = seg_size;
+    s->base = base;
+    strcpy(s->name, sn);
+
+    *seg = s;
+    *mem = (uint8_t *) base + SHM_SEGMENT_HEADER_SIZE;
+
+    return eswb_e_ok;
+}
+
+/**
+ * Make segment visible for shm_segment_attach, must be called after the content is initialized
+ */
+void shm_segment_publish(shm_segment_t *seg) {
+    __atomic_store_n(&seg->magic, SHM_SEGMENT_MAGIC, __ATOMIC_RELEASE);
+}
+
+/**
+ * Map existing segment at the same address it is mapped in the creator's process
+ * @return eswb_e_bus_not_exist if there is no such segment or it is not published yet
+ */
+eswb_rv_t shm_segment_attach(const char *name, shm_segment_t **seg, void **mem, eswb_size_t *size) {
+    char sn[SHM_SEGMENT_NAME_MAX_LEN + 1];
+    shm_name(name, sn);
+
+    int fd = shm_open(sn, O_RDWR, 0);
+    if (fd < 0) {
+        return eswb_e_bus_not_exist;
+    }
+
+    eswb_rv_t rv = eswb_e_ok;
+    struct stat st;
+    shm_segment_t *s = MAP_FAILED;
+
+    do {
+        if ((fstat(fd, &st) != 0) || (st.st_size < SHM_SEGMENT_HEADER_SIZE)) {
+            rv = eswb_e_bus_not_exist;
+            break;
+        }
+
+        shm_segment_t *h = mmap(NULL, SHM_SEGMENT_HEADER_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+        if (h == MAP_FAILED) {
+            rv = eswb_e_mem_reg_na;
+            break;
+        }
+
+        void *base = h->base;
+        eswb_size_t seg_size = h->size;
+        int ready = __atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) == SHM_SEGMENT_MAGIC;
+        munmap(h, SHM_SEGMENT_HEADER_SIZE);
+
+        if (!ready || (seg_size > st.st_size)) {
+            rv = eswb_e_bus_not_exist;
+            break;
+        }
+
+        int flags = MAP_SHARED;
+#ifdef MAP_FIXED_NOREPLACE
+        flags |= MAP_FIXED_NOREPLACE;
+#endif
+        s = mmap(base, seg_size, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if (s == MAP_FAILED) {
+            rv = eswb_e_mem_reg_na;
+            break;
+        }
+
+        if ((void *) s != base) {
+            // address is occupied in this process, pointers inside the segment are not valid here
+            munmap(s, seg_size);
+            rv = eswb_e_mem_reg_na;
+            break;
+        }
+    } while (0);
+
+    close(fd);
+
+    if (rv != eswb_e_ok) {
+        return rv;
+    }
+
+    *seg = s;
+    *mem = (uint8_t *) s + SHM_SEGMENT_HEADER_SIZE;
+    *size = s->size - SHM_SEGMENT_HEADER_SIZE;
+
+    return eswb_e_ok;
+}
+
+/**
+ * Unmap segment from the process
+ * @param do_unlink remove segment's name, so it can't be attached anymore; attached processes keep their mappings
+ */
+eswb_rv_t shm_segment_release(shm_segment_t *seg, int do_unlink) {
+    char sn[SHM_SEGMENT_NAME_MAX_LEN + 1];
+    strcpy(sn, seg->name);
+
+    munmap(seg->base, seg->size);
+
+    if (do_unlink) {
+        shm_unlink(sn);
+    }
+
+    return eswb_e_ok;
+}
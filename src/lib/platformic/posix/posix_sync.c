@@ -16,35 +16,56 @@ typedef struct sync_handle {
     int last_err;
 } posix_sync_t;
 
-eswb_rv_t sync_create(posix_sync_t **s){
-
-    posix_sync_t *ps;
-
-    // TODO remove calloc
-    ps = calloc(1, sizeof(*ps));
-    if (ps == NULL) {
-        return eswb_e_mem_sync_na;
-    }
+uint32_t sync_handle_size(void) {
+    return sizeof(posix_sync_t);
+}
 
+/**
+ * Init sync in caller's memory
+ * @param pshared if nonzero, memory is shared between processes
+ */
+eswb_rv_t sync_init(posix_sync_t *ps, int pshared) {
     pthread_condattr_t cattr;
     pthread_mutexattr_t mattr;
 
     pthread_mutexattr_init(&mattr);
-//    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_init(&cattr);
+
+    if (pshared) {
+        pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    }
 //    pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
-//
-//    pthread_condattr_init(&cattr);
-//    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+
+    eswb_rv_t rv = eswb_e_ok;
 
     if ((ps->last_err = pthread_mutex_init(&ps->mutex, &mattr)) != 0) {
-        // TODO dealloc ps
-        return eswb_e_sync_init;
+        rv = eswb_e_sync_init;
+    } else if ((ps->last_err = pthread_cond_init(&ps->cond, &cattr)) != 0) {
+        pthread_mutex_destroy(&ps->mutex);
+        rv = eswb_e_sync_init;
+    }
+
+    pthread_mutexattr_destroy(&mattr);
+    pthread_condattr_destroy(&cattr);
+
+    return rv;
+}
+
+eswb_rv_t sync_create(posix_sync_t **s){
+
+    posix_sync_t *ps;
+
+    // TODO remove calloc
+    ps = calloc(1, sizeof(*ps));
+    if (ps == NULL) {
+        return eswb_e_mem_sync_na;
     }
 
-    if ((ps->last_err = pthread_cond_init(&ps->cond, &cattr)) != 0) {
-        // TODO deinit mutex
-        // TODO dealloc ps
-        return eswb_e_sync_init;
+    eswb_rv_t rv = sync_init(ps, 0);
+    if (rv != eswb_e_ok) {
+        free(ps);
+        return rv;
     }
 
     *s = ps;
@@ -130,13 +151,18 @@ eswb_rv_t sync_broadcast(posix_sync_t *ps){
     return ((ps->last_err = pthread_cond_broadcast(&ps->cond)) == 0) ? eswb_e_ok : eswb_e_sync_broadcast;
 }
 
-eswb_rv_t sync_destroy(posix_sync_t *ps){
-    //posix_sync_t *ps = posix_sync_cast(s);
-
+eswb_rv_t sync_deinit(posix_sync_t *ps){
     pthread_mutex_destroy(&ps->mutex);
     pthread_cond_destroy(&ps->cond);
 
     // TODO check errors
+    return eswb_e_ok;
+}
+
+eswb_rv_t sync_destroy(posix_sync_t *ps){
+    //posix_sync_t *ps = posix_sync_cast(s);
+
+    sync_deinit(ps);
     free(ps);
 
     return eswb_e_ok;
@@ -0,0 +1,17 @@
+#include <time.h>
+#include <unistd.h>
+
+#include "timing.h"
+
+/**
+ * Monotonic time for timeouts and intervals, not related to the wall clock
+ */
+uint64_t timing_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void timing_sleep_us(uint32_t us) {
+    usleep(us);
+}
@@ -5,13 +5,190 @@
 #include "eswb/topic_proclaiming_tree.h"
 
 
-registry_t *alloc_registry(eswb_size_t topics_num) {
-    eswb_size_t alloc_size = sizeof(topic_t) * topics_num + sizeof(registry_t);
+// every allocation takes whole cache lines, so topics written by different threads don't share them
+#define REG_ARENA_ALIGN 64
+#define REG_ALIGN(__s) (((__s) + REG_ARENA_ALIGN - 1) & ~(REG_ARENA_ALIGN - 1))
+
+#define REG_INDEX_EMPTY 0
+
+static eswb_size_t reg_index_slots(eswb_size_t topics_num) {
+    // power of two and at least twice as much as topics, so probe sequences stay short and always end on empty slot
+    eswb_size_t slots = REG_TOPICS_CHUNK_SIZE * 2;
+    while (slots < topics_num * 2) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+static eswb_size_t reg_index_size(eswb_size_t slots) {
+    return sizeof(reg_name_index_t) + sizeof(eswb_index_t) * slots;
+}
+
+/**
+ * Memory taken by registry's own structures when it is grown up to max_topics, topics' data and syncs are not included
+ */
+eswb_size_t reg_size(eswb_size_t max_topics) {
+    eswb_size_t chunks = (max_topics + REG_TOPICS_CHUNK_SIZE - 1) / REG_TOPICS_CHUNK_SIZE;
+    // outgrown name indexes are kept till registry is destroyed, all generations sum up to twice the last one
+    return REG_ALIGN(sizeof(registry_t)) +
+           chunks * REG_ALIGN(sizeof(topic_chunk_t)) +
+           2 * REG_ALIGN(reg_index_size(reg_index_slots(max_topics)));
+}
+
+static void *reg_alloc(registry_t *reg, eswb_size_t size) {
+    void *p;
+
+    eswb_size_t aligned_size = REG_ALIGN(size);
+
+    if (reg->arena.size == 0) {
+        p = aligned_alloc(REG_ARENA_ALIGN, aligned_size);
+        if (p == NULL) {
+            return NULL;
+        }
+        memset(p, 0, aligned_size);
+        reg->mem_used += aligned_size;
+        return p;
+    }
+
+    if (aligned_size > reg->arena.size - reg->arena.used) {
+        return NULL;
+    }
+
+    p = reg->arena.base + reg->arena.used;
+    reg->arena.used += aligned_size;
+    reg->mem_used += aligned_size;
+    memset(p, 0, size);
+
+    return p;
+}
+
+static void reg_free(registry_t *reg, void *p, eswb_size_t size) {
+    // arena is released as a whole
+    if (reg->arena.size == 0) {
+        free(p);
+        reg->mem_used -= REG_ALIGN(size);
+    }
+}
+
+static uint32_t reg_index_hash(const topic_t *parent, const char *name) {
+    // FNV-1a over parent's id and the name
+    uint32_t h = 2166136261u ^ parent->id;
+    h *= 16777619u;
+    for (int i = 0; (i < ESWB_TOPIC_NAME_MAX_LEN) && (name[i] != 0); i++) {
+        h ^= (uint8_t) name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+ * Lookups and iteration don't take registry's sync. Registering writer fills in everything a topic carries and only
+ * then makes it reachable by release stores of index slots and sibling links, readers load them with acquire.
+ * Topics, chunks and outgrown indexes are never released while registry exists.
+ */
+
+static topic_t *topic_first_child(const topic_t *t) {
+    return __atomic_load_n(&topic_node(t)->first_child, __ATOMIC_ACQUIRE);
+}
+
+static topic_t *topic_next_sibling(const topic_t *t) {
+    return __atomic_load_n(&topic_node(t)->next_sibling, __ATOMIC_ACQUIRE);
+}
+
+static topic_t *reg_index_lookup(registry_t *reg, const topic_t *parent, const char *name) {
+    reg_name_index_t *ni = __atomic_load_n(&reg->name_index, __ATOMIC_ACQUIRE);
+
+    for (uint32_t i = reg_index_hash(parent, name) & ni->mask;; i = (i + 1) & ni->mask) {
+        eswb_index_t slot = __atomic_load_n(&ni->slots[i], __ATOMIC_ACQUIRE);
+        if (slot == REG_INDEX_EMPTY) {
+            return NULL;
+        }
+
+        topic_t *t = reg_topic(reg, slot - 1);
+        if ((topic_node(t)->parent == parent) && (strncmp(topic_node(t)->name, name, ESWB_TOPIC_NAME_MAX_LEN) == 0)) {
+            return t;
+        }
+    }
+}
+
+static void reg_index_insert(registry_t *reg, reg_name_index_t *ni, topic_t *t) {
+    for (uint32_t i = reg_index_hash(topic_node(t)->parent, topic_node(t)->name) & ni->mask;; i = (i + 1) & ni->mask) {
+        eswb_index_t slot = ni->slots[i];
+        if (slot == REG_INDEX_EMPTY) {
+            __atomic_store_n(&ni->slots[i], t->id + 1, __ATOMIC_RELEASE);
+            return;
+        }
+
+        topic_t *n = reg_topic(reg, slot - 1);
+        if ((topic_node(n)->parent == topic_node(t)->parent) && (strncmp(topic_node(n)->name, topic_node(t)->name, ESWB_TOPIC_NAME_MAX_LEN) == 0)) {
+            // sibling with the same name is found first, same as walking through siblings list
+            return;
+        }
+    }
+}
+
+/**
+ * Make sure index has room for one more topic, rehash it into bigger table otherwise
+ */
+static eswb_rv_t reg_index_reserve(registry_t *reg) {
+    reg_name_index_t *old_index = reg->name_index;
+    if ((old_index != NULL) && ((reg->topics_num + 1) * 2 <= old_index->mask + 1)) {
+        return eswb_e_ok;
+    }
+
+    eswb_size_t new_slots = reg_index_slots(reg->topics_num + 1);
+    reg_name_index_t *new_index = reg_alloc(reg, reg_index_size(new_slots));
+    if (new_index == NULL) {
+        return eswb_e_mem_topic_na;
+    }
+
+    new_index->mask = new_slots - 1;
+    new_index->retired = old_index;
+
+    if (old_index != NULL) {
+        // ids order keeps the first of same named siblings in the index
+        for (eswb_index_t id = 1; id < reg->topics_num; id++) {
+            topic_t *t = reg_topic(reg, id);
+            if (topic_node(t)->parent != NULL) {
+                // linked ones only
+                reg_index_insert(reg, new_index, t);
+            }
+        }
+    }
+
+    __atomic_store_n(&reg->name_index, new_index, __ATOMIC_RELEASE);
+
+    return eswb_e_ok;
+}
+
+static eswb_rv_t reg_sync_create(registry_t *reg, struct sync_handle **s) {
+    struct sync_handle *sh = reg_alloc(reg, sync_handle_size());
+    if (sh == NULL) {
+        return eswb_e_mem_sync_na;
+    }
 
-    registry_t *nr = calloc(1, alloc_size);
+    eswb_rv_t rv = sync_init(sh, reg->pshared);
+    if (rv != eswb_e_ok) {
+        reg_free(reg, sh, sync_handle_size());
+        return rv;
+    }
+
+    *s = sh;
+
+    return eswb_e_ok;
+}
+
+static void reg_sync_destroy(registry_t *reg, struct sync_handle *s) {
+    sync_deinit(s);
+    reg_free(reg, s, sync_handle_size());
+}
+
+registry_t *alloc_registry(eswb_size_t topics_num) {
+    registry_t *nr = calloc(1, sizeof(registry_t));
     // TODO issues with struct allocation in array?
     if (nr != NULL) {
         nr->max_topics = topics_num;
+        nr->mem_used = sizeof(registry_t);
     }
 
     return nr;
@@ -22,19 +199,33 @@ topic_t *alloc_topic(registry_t *reg) {
         return NULL;
     }
 
-    topic_t *t = &reg->topics[reg->topics_num];
+    eswb_index_t chunk = reg->topics_num / REG_TOPICS_CHUNK_SIZE;
+    if (reg->topics[chunk] == NULL) {
+        // chunks are never moved or released until registry is destroyed, so topic pointers stay valid
+        reg->topics[chunk] = reg_alloc(reg, sizeof(topic_chunk_t));
+        if (reg->topics[chunk] == NULL) {
+            return NULL;
+        }
+    }
+
+    topic_t *t = reg_topic(reg, reg->topics_num);
 
-    t->reg_ref = reg;
-    t->id = reg->topics_num;
+    t->id = reg->topics_num; // topic_node relies on it
+    topic_node(t)->reg_ref = reg;
+    t->sync_owner = t;
 
-    reg->topics_num++;
+    __atomic_store_n(&reg->topics_num, reg->topics_num + 1, __ATOMIC_RELEASE);
 
     return t;
 }
 
+static eswb_size_t topic_data_alloc_size(topic_t *t) {
+    return t->flags & TOPIC_FLAG_TRIPLE_BUFFER ? topic_mem_tb_stride(t) * 3 : t->data_size;
+}
+
 eswb_rv_t alloc_topic_data(topic_t *t) {
     if (t->data_size > 0) {
-        t->data = calloc(1, t->data_size);
+        t->data = reg_alloc(topic_node(t)->reg_ref, topic_data_alloc_size(t));
         if (t->data == NULL) {
             return eswb_e_mem_data_na;
         }
@@ -43,16 +234,20 @@ eswb_rv_t alloc_topic_data(topic_t *t) {
 }
 
 eswb_rv_t topic_dealloc_resources(topic_t *t) {
-    if (!(t->flags & TOPIC_FLAG_MAPPED_TO_PARENT)) {
+    registry_t *reg = topic_node(t)->reg_ref;
+
+    if (!(t->flags & (TOPIC_FLAG_MAPPED_TO_PARENT | TOPIC_FLAG_ALIAS))) {
         if (t->fifo_ext != NULL) {
-            free(t->fifo_ext);
-        }
-        if (t->data != NULL) {
-            free(t->data);
+            if (t->data != NULL) {
+                reg_free(reg, t->data, t->fifo_ext->fifo_size * t->fifo_ext->elem_step);
+            }
+            reg_free(reg, t->fifo_ext, sizeof(*t->fifo_ext));
+        } else if (t->data != NULL) {
+            reg_free(reg, t->data, topic_data_alloc_size(t));
         }
         if (!(t->flags & TOPIC_FLAG_USES_PARENT_SYNC)) {
             if (t->sync != NULL) {
-                sync_destroy(t->sync);
+                reg_sync_destroy(reg, t->sync);
             }
         }
     }
@@ -61,16 +256,36 @@ eswb_rv_t topic_dealloc_resources(topic_t *t) {
 }
 
 eswb_rv_t reg_destroy(registry_t *reg) {
+    if (reg->pshared) {
+        // other processes might still use it, memory is released with the shared segment
+        return eswb_e_ok;
+    }
+
     for (uint32_t i = 0; i < reg->topics_num; i++) {
-        topic_dealloc_resources(&reg->topics[i]);
+        topic_dealloc_resources(reg_topic(reg, i));
+    }
+    if (reg->sync != NULL) {
+        reg_sync_destroy(reg, reg->sync);
+    }
+    if (reg->arena.size == 0) {
+        for (uint32_t i = 0; i < REG_TOPICS_CHUNKS_MAX; i++) {
+            free(reg->topics[i]);
+        }
+        for (reg_name_index_t *ni = reg->name_index, *next; ni != NULL; ni = next) {
+            next = ni->retired;
+            free(ni);
+        }
+        free(reg);
+    } else if (reg->arena.owned) {
+        free(reg->arena.base);
+        free(reg);
     }
-    free(reg);
     return eswb_e_ok;
 }
 
 static eswb_rv_t alloc_fifo_topic_data_generalized(topic_t *t, eswb_size_t fifo_elem_data_size, int do_align) {
 
-    t->fifo_ext = calloc(1, sizeof(*t->fifo_ext));
+    t->fifo_ext = reg_alloc(topic_node(t)->reg_ref, sizeof(*t->fifo_ext));
     if (t->fifo_ext == NULL) {
         return eswb_e_mem_data_na;
     }
@@ -88,9 +303,9 @@ static eswb_rv_t alloc_fifo_topic_data_generalized(topic_t *t, eswb_size_t fifo_
     t->fifo_ext->state.head = 0;
     t->fifo_ext->state.lap_num = 0;
 
-    t->data = calloc(t->fifo_ext->fifo_size, t->fifo_ext->elem_step);
+    t->data = reg_alloc(topic_node(t)->reg_ref, t->fifo_ext->fifo_size * t->fifo_ext->elem_step);
     if (t->data == NULL ) {
-        free(t->fifo_ext);
+        reg_free(topic_node(t)->reg_ref, t->fifo_ext, sizeof(*t->fifo_ext));
         return eswb_e_mem_data_na;
     }
 
@@ -117,8 +332,8 @@ void dealloc_topic(topic_t *t) {
 topic_t *reg_find_topic_among_siblings(topic_t *first_child, const char *topic_name) {
 
     topic_t *n;
-    for (n = first_child; n != NULL; n = n->next_sibling) {
-        if (strncmp(n->name, topic_name, ESWB_TOPIC_NAME_MAX_LEN) == 0) {
+    for (n = first_child; n != NULL; n = topic_next_sibling(n)) {
+        if (strncmp(topic_node(n)->name, topic_name, ESWB_TOPIC_NAME_MAX_LEN) == 0) {
             return n;
         }
     }
@@ -127,13 +342,13 @@ topic_t *reg_find_topic_among_siblings(topic_t *first_child, const char *topic_n
 }
 
 
-static topic_t *find_topic(topic_t *root, const char *find_path) {
+static topic_t *find_topic(registry_t *reg, const char *find_path) {
 
     char *rest;
     char *topic_name;
     //int first_run = -1;
+    topic_t *root = reg_topic(reg, 0);
     topic_t *t;
-    topic_t *child_t;
 
 #define DELIM "/"
 
@@ -141,15 +356,14 @@ static topic_t *find_topic(topic_t *root, const char *find_path) {
 
     strncpy(path, find_path, ESWB_TOPIC_MAX_PATH_LEN);
     topic_name = strtok_r(path, DELIM, &rest);
-    if (strcmp(topic_name, root->name) != 0) {
+    if (strcmp(topic_name, topic_node(root)->name) != 0) {
         return NULL;
     }
 
     t = root;
 
     while((topic_name = strtok_r(NULL, DELIM, &rest)) != NULL) {
-        child_t = t->first_child;
-        t = reg_find_topic_among_siblings(child_t, topic_name);
+        t = reg_index_lookup(reg, t, topic_name);
         if (t == NULL) {
             return NULL;
         }
@@ -224,9 +438,9 @@ static int walk_through_tree(topic_t *t, char *dir_ptrs[], crawling_lambda_t lam
         return WALK_RV_TERMINAL;
     }
 
-    for (topic_t *n = t; n != NULL; n = n->next_sibling) {
-        if (match_str(n->name, dir_ptrs[0])) {
-            int wt_rv = walk_through_tree(t->first_child, &dir_ptrs[1], lambda, usr_l_data);
+    for (topic_t *n = t; n != NULL; n = topic_next_sibling(n)) {
+        if (match_str(topic_node(n)->name, dir_ptrs[0])) {
+            int wt_rv = walk_through_tree(topic_first_child(t), &dir_ptrs[1], lambda, usr_l_data);
             switch (wt_rv) {
                 case WALK_RV_NO_NESTED_TOPIC:
                 case WALK_RV_TERMINAL:
@@ -272,7 +486,7 @@ static eswb_rv_t fill_in_topic(topic_t *t, topic_proclaiming_tree_t *tsrc) {
         return eswb_e_invargs;
     }
 
-    strncpy(t->name, tsrc->name, ESWB_TOPIC_NAME_MAX_LEN);
+    strncpy(topic_node(t)->name, tsrc->name, ESWB_TOPIC_NAME_MAX_LEN);
     t->type = tsrc->type;
     t->data_size = tsrc->data_size;
 
@@ -280,10 +494,15 @@ static eswb_rv_t fill_in_topic(topic_t *t, topic_proclaiming_tree_t *tsrc) {
 }
 
 
-static eswb_rv_t topic_add_child(topic_t *parent, topic_proclaiming_tree_t *topic_struct, topic_t **rv_tpc,
-                          int synced) {
+static eswb_rv_t topic_add_child(topic_t *parent, topic_proclaiming_tree_t *topic_struct, topic_t *alias,
+                                 topic_t **rv_tpc, int synced) {
+
+    // reserved ahead, so linking the new topic can't fail
+    if (reg_index_reserve(topic_node(parent)->reg_ref) != eswb_e_ok) {
+        return eswb_e_mem_topic_na;
+    }
 
-    topic_t *new = alloc_topic(parent->reg_ref);
+    topic_t *new = alloc_topic(topic_node(parent)->reg_ref);
 
     if (new == NULL) {
         return eswb_e_mem_topic_na;
@@ -298,8 +517,71 @@ static eswb_rv_t topic_add_child(topic_t *parent, topic_proclaiming_tree_t *topi
         return rv;
     }
 
-    if (topic_struct->flags & TOPIC_FLAG_MAPPED_TO_PARENT) {
+    if ((new->type == tt_fifo) && (topic_struct->flags & TOPIC_FLAG_LOCKFREE_FIFO)) {
+        new->flags |= TOPIC_FLAG_LOCKFREE_FIFO;
+    }
+
+    if (topic_struct->flags & TOPIC_FLAG_TRIPLE_BUFFER) {
+        switch (new->type) {
+            case tt_dir:
+            case tt_fifo:
+            case tt_event_queue:
+            case tt_byte_buffer:
+                return eswb_e_invargs;
+
+            default:
+                if (topic_struct->flags & (TOPIC_FLAG_MAPPED_TO_PARENT | TOPIC_FLAG_USES_PARENT_SYNC)) {
+                    return eswb_e_invargs;
+                }
+                new->flags |= TOPIC_FLAG_TRIPLE_BUFFER;
+                break;
+        }
+    }
+
+    if (topic_struct->flags & TOPIC_FLAG_CONFLATING) {
+        if (new->type != tt_event_queue) {
+            return eswb_e_invargs;
+        }
+        new->flags |= TOPIC_FLAG_CONFLATING;
+    }
+
+    if (parent->sync_owner->flags & TOPIC_FLAG_TRIPLE_BUFFER) {
+        if (!(topic_struct->flags & TOPIC_FLAG_MAPPED_TO_PARENT)) {
+            // seq of triple buffered topic counts generations, it can't be shared with plain seqlock
+            return eswb_e_invargs;
+        }
+        // members are read and written from the buffers of the struct
+        new->flags |= TOPIC_FLAG_TRIPLE_BUFFER;
+    }
+
+    if (alias != NULL) {
+        switch (new->type) {
+            case tt_dir:
+            case tt_fifo:
+            case tt_event_queue:
+            case tt_byte_buffer:
+                return eswb_e_invargs;
+
+            default:
+                break;
+        }
+        if (parent->type != tt_dir) {
+            return eswb_e_notdir;
+        }
+        topic_t *ao = alias->sync_owner;
+        if ((topic_struct->flags & (TOPIC_FLAG_MAPPED_TO_PARENT | TOPIC_FLAG_USES_PARENT_SYNC | TOPIC_FLAG_TRIPLE_BUFFER)) ||
+            (alias->fifo_ext != NULL) || (alias->data == NULL) ||
+            (alias->data + new->data_size > ao->data + ao->data_size)) {
+            return eswb_e_invargs;
+        }
+        // behaves as a member of the aliased topic's sync owner, children are mapped to it as usual
+        new->sync = alias->sync;
+        new->sync_owner = ao;
+        new->data = alias->data;
+        new->flags |= TOPIC_FLAG_ALIAS | (ao->flags & TOPIC_FLAG_TRIPLE_BUFFER);
+    } else if (topic_struct->flags & TOPIC_FLAG_MAPPED_TO_PARENT) {
         new->sync = parent->sync;
+        new->sync_owner = parent->sync_owner;
         if ((parent->type == tt_fifo) || (parent->type == tt_event_queue)) {
             new->data = parent->data;
             new->fifo_ext = parent->fifo_ext;
@@ -356,10 +638,11 @@ static eswb_rv_t topic_add_child(topic_t *parent, topic_proclaiming_tree_t *topi
 
             if (topic_struct->flags & TOPIC_FLAG_USES_PARENT_SYNC) {
                 new->sync = parent->sync;
+                new->sync_owner = parent->sync_owner;
                 new->flags |= TOPIC_FLAG_USES_PARENT_SYNC;
             } else {
                 if (synced) {
-                    rv = sync_create(&new->sync);
+                    rv = reg_sync_create(topic_node(new)->reg_ref, &new->sync);
                     if (rv != eswb_e_ok) {
                         break;
                     }
@@ -373,27 +656,36 @@ static eswb_rv_t topic_add_child(topic_t *parent, topic_proclaiming_tree_t *topi
         }
     }
 
-    // link inside registry
-    new->parent = parent;
     // inheriting event queue mask
     new->evq_mask = parent->evq_mask;
 
+    *rv_tpc = new;
 
-    if (parent->first_child == NULL) {
-        parent->first_child = new;
+    return eswb_e_ok;
+}
+
+/**
+ * Make topic reachable from its parent, it must be completely set up along with its children before.
+ * Topics without parent are not indexed, so topics left by failed registration stay unreachable.
+ */
+static void topic_link(topic_t *parent, topic_t *t) {
+    registry_t *reg = topic_node(t)->reg_ref;
+
+    topic_node(t)->parent = parent;
+
+    if (topic_node(parent)->first_child == NULL) {
+        __atomic_store_n(&topic_node(parent)->first_child, t, __ATOMIC_RELEASE);
     } else {
         topic_t *n;
-        for (n = parent->first_child; n->next_sibling != NULL; n = n->next_sibling);
-        n->next_sibling = new;
+        for (n = topic_node(parent)->first_child; topic_node(n)->next_sibling != NULL; n = topic_node(n)->next_sibling);
+        __atomic_store_n(&topic_node(n)->next_sibling, t, __ATOMIC_RELEASE);
     }
 
-    *rv_tpc = new;
-
-    return eswb_e_ok;
+    reg_index_insert(reg, reg->name_index, t);
 }
 
 static eswb_rv_t topics_tree_register(topic_t *mount_point, topic_proclaiming_tree_t *new_topic_struct,
-                               int synced) {
+                                      topic_t *alias, int synced) {
     // TODO make NO recursion;
 
     // go over new_topic structure
@@ -405,7 +697,7 @@ static eswb_rv_t topics_tree_register(topic_t *mount_point, topic_proclaiming_tr
     //printf("%s. %s\n", __func__, new_topic_struct->name);
 
     eswb_rv_t  rv;
-    rv = topic_add_child(mount_point, new_topic_struct, &new, synced);
+    rv = topic_add_child(mount_point, new_topic_struct, alias, &new, synced);
 
     if (rv != eswb_e_ok) {
         return rv;
@@ -417,71 +709,153 @@ static eswb_rv_t topics_tree_register(topic_t *mount_point, topic_proclaiming_tr
     for (n = INDEX2PTR(new_topic_struct, new_topic_struct->first_child_ind);
             n != NULL;
                 n = INDEX2PTR(n, n->next_sibling_ind)) {
-        rv = topics_tree_register(new, n, synced);
+        rv = topics_tree_register(new, n, NULL, synced);
         if (rv != eswb_e_ok) {
             return rv;
         }
     }
 
+    // linked bottom up, so readers see the new subtree complete or don't see it at all
+    topic_link(mount_point, new);
+
     return eswb_e_ok;
 }
 
 eswb_rv_t reg_tree_register(registry_t *reg, topic_t *mounting_topic, topic_proclaiming_tree_t *new_topic_struct, int synced) {
     if (synced) sync_take(reg->sync);
-    eswb_rv_t rv = topics_tree_register(mounting_topic, new_topic_struct, synced);
+    eswb_rv_t rv = topics_tree_register(mounting_topic, new_topic_struct, NULL, synced);
     if (synced) sync_give(reg->sync);
 
     return rv;
 }
 
-
-topic_t *reg_find_topic(registry_t *reg, const char *path, int synced) {
-
+/**
+ * Register tree which root takes no memory of its own, but is mapped onto memory of alias topic and shares its sync.
+ * Alias topic might belong to the other registry, it must outlive the tree.
+ */
+eswb_rv_t reg_tree_register_alias(registry_t *reg, topic_t *mounting_topic, topic_proclaiming_tree_t *new_topic_struct,
+                                  topic_t *alias, int synced) {
     if (synced) sync_take(reg->sync);
-    topic_t *rv = find_topic(&reg->topics[0], path);
+    eswb_rv_t rv = topics_tree_register(mounting_topic, new_topic_struct, alias, synced);
     if (synced) sync_give(reg->sync);
 
     return rv;
 }
 
 
-eswb_rv_t reg_create(const char *root_name, registry_t **new_reg, eswb_size_t max_topics, int synced) {
-    registry_t *nr = alloc_registry(max_topics);
+topic_t *reg_find_topic(registry_t *reg, const char *path) {
+    return find_topic(reg, path);
+}
 
-    if (nr == NULL) {
-        return eswb_e_mem_reg_na;
-    }
 
-    if (strlen(root_name) > ESWB_TOPIC_NAME_MAX_LEN ) {
-        return eswb_e_invargs;
-    }
+void reg_get_stats(registry_t *reg, bus_stats_t *stats) {
+    stats->topics_num = __atomic_load_n(&reg->topics_num, __ATOMIC_RELAXED);
+    stats->mem_used = __atomic_load_n(&reg->mem_used, __ATOMIC_RELAXED);
+}
 
-    eswb_rv_t rv;
 
+static eswb_rv_t reg_init(registry_t *nr, const char *root_name, int synced) {
+    eswb_rv_t rv;
 
-    topic_t *root = alloc_topic(nr);
-    if (root == NULL) {
-        // TODO dealloc nr
-        return eswb_e_mem_topic_na;
+    if ((nr->max_topics == 0) || (nr->max_topics > REG_TOPICS_MAX)) {
+        return eswb_e_invargs;
     }
 
-    rv = sync_create(&root->sync);
+    rv = reg_index_reserve(nr);
     if (rv != eswb_e_ok) {
-        // TODO dealloc nr and root
         return rv;
     }
 
-    strncpy(root->name, root_name, ESWB_TOPIC_NAME_MAX_LEN);
+    topic_t *root = alloc_topic(nr);
+    if (root == NULL) {
+        return eswb_e_mem_topic_na;
+    }
+
+    strncpy(topic_node(root)->name, root_name, ESWB_TOPIC_NAME_MAX_LEN);
     root->type = tt_dir;
 
     if (synced) {
-        rv = sync_create(&nr->sync);
+        rv = reg_sync_create(nr, &root->sync);
+        if (rv != eswb_e_ok) {
+            return rv;
+        }
+
+        rv = reg_sync_create(nr, &nr->sync);
         if (rv != eswb_e_ok) {
-            // TODO dealloc reg
             return rv;
         }
-    } else {
-        root->sync = NULL;
+    }
+
+    return eswb_e_ok;
+}
+
+/**
+ * Create registry on heap
+ * @param arena_size if nonzero, topics, their data and syncs are placed in a single arena of this size allocated
+ * at once, otherwise each of them is allocated separately
+ */
+eswb_rv_t reg_create(const char *root_name, registry_t **new_reg, eswb_size_t max_topics, eswb_size_t arena_size,
+                     int synced) {
+    if (strlen(root_name) > ESWB_TOPIC_NAME_MAX_LEN ) {
+        return eswb_e_invargs;
+    }
+
+    registry_t *nr = alloc_registry(max_topics);
+
+    if (nr == NULL) {
+        return eswb_e_mem_reg_na;
+    }
+
+    if (arena_size > 0) {
+        arena_size = REG_ALIGN(arena_size);
+        nr->arena.base = aligned_alloc(REG_ARENA_ALIGN, arena_size);
+        if (nr->arena.base == NULL) {
+            free(nr);
+            return eswb_e_mem_reg_na;
+        }
+        memset(nr->arena.base, 0, arena_size);
+        nr->arena.size = arena_size;
+        nr->arena.owned = -1;
+    }
+
+    eswb_rv_t rv = reg_init(nr, root_name, synced);
+    if (rv != eswb_e_ok) {
+        reg_destroy(nr);
+        return rv;
+    }
+
+    *new_reg = nr;
+    return eswb_e_ok;
+}
+
+/**
+ * Create registry in caller's memory, topics, their data and syncs are allocated in the rest of it
+ * @param pshared memory is shared between processes, so are syncs
+ */
+eswb_rv_t reg_create_in_memory(const char *root_name, void *mem, eswb_size_t mem_size, eswb_size_t max_topics,
+                               int synced, int pshared, registry_t **new_reg) {
+    if (strlen(root_name) > ESWB_TOPIC_NAME_MAX_LEN ) {
+        return eswb_e_invargs;
+    }
+
+    eswb_size_t rs = REG_ALIGN(sizeof(registry_t));
+    if (((uintptr_t) mem & (REG_ARENA_ALIGN - 1)) || (mem_size <= rs)) {
+        return eswb_e_mem_reg_na;
+    }
+
+    registry_t *nr = mem;
+    memset(nr, 0, rs);
+
+    nr->max_topics = max_topics;
+    nr->pshared = pshared;
+    nr->mem_used = rs;
+    nr->arena.base = (uint8_t *) mem + rs;
+    nr->arena.size = mem_size - rs;
+    nr->arena.used = 0;
+
+    eswb_rv_t rv = reg_init(nr, root_name, synced);
+    if (rv != eswb_e_ok) {
+        return rv;
     }
 
     *new_reg = nr;
@@ -496,22 +870,23 @@ void print_topic_oneline(topic_t *t, int level, int last) {
         printf(" ");
     }
 
-    printf("%s\n", t->name);
+    printf("%s\n", topic_node(t)->name);
     //printf("%s id == %d\n", t->name, t->id);
 }
 
 
 topic_t *topic_tree_next(topic_t *r) {
 
-    if (r->first_child != NULL) {
-        return r->first_child;
-    } else if (r->next_sibling != NULL) {
-        return r->next_sibling;
+    topic_t *n;
+
+    if ((n = topic_first_child(r)) != NULL) {
+        return n;
+    } else if ((n = topic_next_sibling(r)) != NULL) {
+        return n;
     } else {
-        topic_t *n;
-        for(n = r->parent; n != NULL; n = n->parent) {
-            if (n->next_sibling != NULL) {
-                return n->next_sibling;
+        for(topic_t *p = topic_node(r)->parent; p != NULL; p = topic_node(p)->parent) {
+            if ((n = topic_next_sibling(p)) != NULL) {
+                return n;
             }
         }
     }
@@ -524,8 +899,12 @@ topic_t *topic_tree_next_filtered(topic_t *r) {
     do {
         r = topic_tree_next(r);
         if (r != NULL) {
+            // event queue's sub-queues bring one more level
+            topic_t *p = topic_node(r)->parent;
+            topic_t *pp = p != NULL ? topic_node(p)->parent : NULL;
             loop = (r->type == tt_event_queue)
-                        || ((r->parent != NULL) && (r->parent->type == tt_event_queue));
+                        || ((p != NULL) && (p->type == tt_event_queue))
+                        || ((pp != NULL) && (pp->type == tt_event_queue));
         } else {
             loop = 0;
         }
@@ -535,8 +914,8 @@ topic_t *topic_tree_next_filtered(topic_t *r) {
 }
 
 int parent_has_child(topic_t *parent, topic_t *child) {
-    for (topic_t *n = child; n != NULL; n = n->parent) {
-        if (parent == n->parent) {
+    for (topic_t *n = child; n != NULL; n = topic_node(n)->parent) {
+        if (parent == topic_node(n)->parent) {
             return -1;
         }
     }
@@ -544,13 +923,16 @@ int parent_has_child(topic_t *parent, topic_t *child) {
 }
 
 eswb_rv_t
-reg_get_next_topic_info(registry_t *reg, topic_t *parent, eswb_topic_id_t id, topic_extract_t *extract, int synced) {
+reg_get_next_topic_info(registry_t *reg, topic_t *parent, eswb_topic_id_t id, topic_extract_t *extract) {
     eswb_rv_t rv = eswb_e_ok;
 
-    if (synced) sync_take(reg->sync);
-
     do {
-        topic_t *t = &reg->topics[id];
+        if (id >= __atomic_load_n(&reg->topics_num, __ATOMIC_ACQUIRE)) {
+            rv = eswb_e_invargs;
+            break;
+        }
+
+        topic_t *t = reg_topic(reg, id);
         if (id != t->id) {
             rv = eswb_e_invargs;
             break;
@@ -562,11 +944,11 @@ reg_get_next_topic_info(registry_t *reg, topic_t *parent, eswb_topic_id_t id, to
             break;
         }
 
-        strncpy(extract->info.name, t->name, PR_TREE_NAME_ALIGNED - 1);
-        extract->parent_id = t->parent != NULL ? t->parent->id : 0;
+        strncpy(extract->info.name, topic_node(t)->name, PR_TREE_NAME_ALIGNED - 1);
+        extract->parent_id = topic_node(t)->parent != NULL ? topic_node(t)->parent->id : 0;
         extract->info.type = t->type;
         extract->info.data_size = t->data_size;
-        extract->info.data_offset = t->flags & TOPIC_FLAG_MAPPED_TO_PARENT ? t->data - t->parent->data : 0;
+        extract->info.data_offset = t->flags & TOPIC_FLAG_MAPPED_TO_PARENT ? t->data - topic_node(t)->parent->data : 0;
         extract->info.flags = t->flags;
         extract->info.topic_id = t->id;
         extract->info.abs_ind = 0;
@@ -575,8 +957,6 @@ reg_get_next_topic_info(registry_t *reg, topic_t *parent, eswb_topic_id_t id, to
         extract->info.first_child_ind = PR_TREE_NO_REF_IND;
     } while (0);
 
-    if (synced) sync_give(reg->sync);
-
     return rv;
 }
 
@@ -585,12 +965,12 @@ void topic_print_tree(topic_t *t, int level, int process_siblings) {
         return;
     }
 
-    print_topic_oneline(t, level, t->next_sibling == NULL ? -1 : 0 );
+    print_topic_oneline(t, level, topic_node(t)->next_sibling == NULL ? -1 : 0 );
 
-    topic_print_tree(t->first_child, level + 1, 1);
+    topic_print_tree(topic_node(t)->first_child, level + 1, 1);
 
     if (process_siblings) {
-        for (topic_t *n = t->next_sibling; n != NULL; n = n->next_sibling) {
+        for (topic_t *n = topic_node(t)->next_sibling; n != NULL; n = topic_node(n)->next_sibling) {
             topic_print_tree(n, level, 0);
         }
     }
@@ -599,7 +979,7 @@ void topic_print_tree(topic_t *t, int level, int process_siblings) {
 void reg_print(registry_t *reg) {
     //printf("%c\n", 14);
 
-    topic_print_tree(&reg->topics[0], 0, 1);
+    topic_print_tree(reg_topic(reg, 0), 0, 1);
 
     //printf("%c\n", 15);
 }
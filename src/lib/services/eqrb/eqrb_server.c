@@ -25,6 +25,9 @@ send_topic(device_descr_t dd, const eqrb_media_driver_t *dr, eqrb_interaction_he
     event->topic_id = parent_tid;
     event->size = sizeof(topic_proclaiming_tree_t) * topics_num; // for now sending record by record
     event->type = eqr_topic_proclaim;
+    // initial sync is not an event of the bus
+    event->seq = 0;
+    event->timestamp = 0;
 
     eqrb_dbg_msg("---- send proclaim info for topic \"%s\" tid == %d parent_tid == %d topics_num == %d ----",
                  ((topic_proclaiming_tree_t *) EVENT_QUEUE_TRANSFER_DATA(event))->name,
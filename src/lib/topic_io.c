@@ -3,6 +3,11 @@
 #include <stdio.h>
 #include <pthread.h>
 
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/eventfd.h>
+#endif
+
 #include "local_buses.h"
 #include "topic_io.h"
 #include "topic_mem.h"
@@ -10,11 +15,129 @@
 #include "registry.h"
 
 
+#define SEQLOCK_READ_ATTEMPTS 16
+
+static uint64_t wakeup_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Wakeup latencies are measured along with bus's counters, so there is no clock reading otherwise
+ */
+static int wakeup_hist_enabled(topic_t *t) {
+    return __atomic_load_n(&topic_node(t)->reg_ref->counters_enabled, __ATOMIC_RELAXED);
+}
+
+/**
+ * Account time from waking up by the update till the waiter got the sync back
+ * @param wait_start_ns time waiting began, earlier wakeup time means waiter resumed not by an update
+ */
+static void wakeup_hist_account(topic_t *t, uint64_t wait_start_ns) {
+    uint64_t woken_ns = __atomic_load_n(&topic_node(t->sync_owner)->wake_ns, __ATOMIC_RELAXED);
+    if (woken_ns < wait_start_ns) {
+        return;
+    }
+
+    uint64_t latency = wakeup_clock_ns() - woken_ns;
+    int b = latency > 0 ? 63 - __builtin_clzll(latency) : 0;
+    if (b >= ESWB_WAKEUP_HIST_BUCKETS) {
+        b = ESWB_WAKEUP_HIST_BUCKETS - 1;
+    }
+    __atomic_fetch_add(&topic_node(t)->wakeup_hist.buckets[b], 1, __ATOMIC_RELAXED);
+}
+
+static eswb_rv_t sync_wait_measured(topic_t *t, uint32_t timeout_us) {
+    eswb_rv_t rv;
+    uint64_t wait_start_ns = wakeup_hist_enabled(t) ? wakeup_clock_ns() : 0;
+
+    if (timeout_us > 0) {
+        rv = sync_wait_timed(t->sync, timeout_us);
+    } else {
+        rv = sync_wait(t->sync);
+    }
+
+    if ((rv == eswb_e_ok) && (wait_start_ns != 0)) {
+        wakeup_hist_account(t, wait_start_ns);
+    }
+
+    return rv;
+}
+
+/**
+ * Wait on topic's sync, which must be taken. Waiters are counted, so updates skip broadcast when nobody waits
+ */
+static eswb_rv_t topic_sync_wait(topic_t *t, uint32_t timeout_us) {
+    eswb_rv_t rv;
+    topic_t *o = t->sync_owner;
+
+    __atomic_fetch_add(&o->waiters, 1, __ATOMIC_SEQ_CST);
+    rv = sync_wait_measured(t, timeout_us);
+    __atomic_fetch_sub(&o->waiters, 1, __ATOMIC_RELAXED);
+
+    return rv;
+}
+
+static void topic_stats_inc(uint32_t *cnt) {
+    __atomic_fetch_add(cnt, 1, __ATOMIC_RELAXED);
+}
+
+void topic_io_listener_signal(topic_listener_t *l, uint32_t ready_bit) {
+#ifdef __linux__
+    if (l->event_fd >= 0) {
+        eventfd_write(l->event_fd, 1);
+        return;
+    }
+#endif
+
+    sync_take(l->sync);
+    l->ready_mask |= ready_bit;
+    sync_broadcast(l->sync);
+    sync_give(l->sync);
+}
+
+static void topic_listeners_notify(topic_t *o) {
+    for (topic_listener_link_t *link = topic_node(o)->listeners; link != NULL; link = link->next) {
+        topic_io_listener_signal(link->listener, link->ready_bit);
+    }
+}
+
+/**
+ * Wake up threads blocked on topic's sync, which must be taken
+ */
+static void topic_sync_wake(topic_t *t) {
+    if (__atomic_load_n(&t->sync_owner->waiters, __ATOMIC_RELAXED) > 0) {
+        if (wakeup_hist_enabled(t)) {
+            __atomic_store_n(&topic_node(t->sync_owner)->wake_ns, wakeup_clock_ns(), __ATOMIC_RELAXED);
+        }
+        sync_broadcast(t->sync);
+        topic_listeners_notify(t->sync_owner);
+        topic_stats_inc(&t->stats.wakeups);
+    } else {
+        topic_stats_inc(&t->stats.wakeups_skipped);
+    }
+}
+
 eswb_rv_t topic_io_read(topic_t *t, void *data, int synced) {
 
-    if (synced) sync_take(t->sync);
+    if (!synced) {
+        return topic_mem_simply_copy(t, data);
+    }
+
+    // readers don't take the sync, writer bumps the seqlock counter around data modification,
+    // for triple buffered topics retry means writer published twice during the copy
+    for (int i = 0; i < SEQLOCK_READ_ATTEMPTS; i++) {
+        if (topic_mem_read_consistent(t, data) == eswb_e_ok) {
+            return eswb_e_ok;
+        }
+    }
+
+    // writer is preempted in the middle of update or updates are too frequent, so wait for it on the sync;
+    // writers fill the next generation under the sync only, so the latest one is stable while it is taken
+    sync_take(t->sync);
     eswb_rv_t rv = topic_mem_simply_copy(t, data);
-    if (synced) sync_give(t->sync);
+    sync_give(t->sync);
 
     return rv;
 }
@@ -27,18 +150,22 @@ eswb_rv_t topic_io_get_update(topic_t *t, void *data, int synced, uint32_t timeo
         sync_take(t->sync);
 
         do {
-            if (timeout_us) {
-                rv = sync_wait_timed(t->sync, timeout_us);
-            } else {
-                rv = sync_wait(t->sync);
-            }
+            rv = topic_sync_wait(t, timeout_us);
             if (rv != eswb_e_ok) {
                 break;
             }
+            if (t->flags & TOPIC_FLAG_TRIPLE_BUFFER) {
+                // copied after the sync is given, so publisher is not held by the copy
+                break;
+            }
             rv = topic_mem_simply_copy(t, data);
         } while (0);
 
         sync_give(t->sync);
+
+        if ((rv == eswb_e_ok) && (t->flags & TOPIC_FLAG_TRIPLE_BUFFER)) {
+            rv = topic_io_read(t, data, synced);
+        }
     } else {
         return topic_io_read(t, data, 0);
     };
@@ -55,15 +182,122 @@ static int32_t fifo_index_delta(eswb_fifo_index_t i1, eswb_fifo_index_t i2, eswb
     return rv;
 }
 
+static int fifo_rcvr_is_lapped(const topic_fifo_state_t *s, const fifo_rcvr_state_t *rcvr_state) {
+    int32_t dlap = fifo_index_delta(s->lap_num,  rcvr_state->lap, ESWB_FIFO_INDEX_OVERFLOW);
+    int32_t dind = s->head - rcvr_state->tail;
+
+    return (dlap > 1) || ((dlap == 1) && (dind >= 0));
+}
+
+static void fifo_rcvr_advance(topic_t *t, fifo_rcvr_state_t *rcvr_state, eswb_size_t num) {
+    eswb_size_t pos = rcvr_state->tail + num;
+    rcvr_state->tail = pos % t->fifo_ext->fifo_size;
+    rcvr_state->lap += pos / t->fifo_ext->fifo_size;
+}
+
+/**
+ * Number of elements ready to be read by the receiver, which must not be lapped
+ */
+static eswb_size_t fifo_rcvr_available(topic_t *t, const fifo_rcvr_state_t *rcvr_state) {
+    topic_fifo_state_t s;
+    topic_mem_fifo_get_state(t, &s);
+
+    if (s.lap_num == rcvr_state->lap) {
+        return s.head - rcvr_state->tail;
+    } else {
+        return s.head + t->fifo_ext->fifo_size - rcvr_state->tail;
+    }
+}
+
+static int topic_is_lockfree_fifo(topic_t *t) {
+    return (t->fifo_ext != NULL) && (t->sync_owner->flags & TOPIC_FLAG_LOCKFREE_FIFO);
+}
+
+/**
+ * Single attempt to read next element without taking sync; producer may overwrite the slot while it is copied,
+ * so the state is validated again after the copy
+ */
+static eswb_rv_t fifo_lockfree_try_read(topic_t *t, fifo_rcvr_state_t *rcvr_state, void *data) {
+    eswb_rv_t rv = eswb_e_ok;
+    topic_fifo_state_t s;
+
+    topic_mem_fifo_get_state(t, &s);
+
+    do {
+        if (fifo_rcvr_is_lapped(&s, rcvr_state)) {
+            rv = eswb_e_fifo_rcvr_underrun;
+            // the slot at head might be under overwriting right now, so skip to the next one
+            rcvr_state->lap = s.lap_num - 1;
+            rcvr_state->tail = s.head + 1;
+            if (rcvr_state->tail >= t->fifo_ext->fifo_size) {
+                rcvr_state->tail = 0;
+                rcvr_state->lap++;
+            }
+        } else if (s.head == rcvr_state->tail) {
+            return eswb_e_no_update;
+        }
+
+        topic_mem_read_fifo(t, rcvr_state->tail, data);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        __atomic_load(&t->fifo_ext->state, &s, __ATOMIC_RELAXED);
+        // if copied slot got overwritten, start over from the oldest element
+    } while (fifo_rcvr_is_lapped(&s, rcvr_state));
+
+    fifo_rcvr_advance(t, rcvr_state, 1);
+
+    return rv;
+}
+
+static eswb_rv_t fifo_lockfree_pop(topic_t *t, fifo_rcvr_state_t *rcvr_state, void *data, int do_wait,
+                                   uint32_t timeout_us) {
+    eswb_rv_t rv = fifo_lockfree_try_read(t, rcvr_state, data);
+    if ((rv != eswb_e_no_update) || !do_wait) {
+        return rv;
+    }
+
+    topic_t *o = t->sync_owner;
+
+    // announce waiting before rechecking the state, producer checks waiters after publishing the state
+    sync_take(t->sync);
+    __atomic_fetch_add(&o->waiters, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    do {
+        rv = fifo_lockfree_try_read(t, rcvr_state, data);
+        if (rv != eswb_e_no_update) {
+            break;
+        }
+        rv = sync_wait_measured(t, timeout_us);
+    } while (rv == eswb_e_ok);
+
+    __atomic_fetch_sub(&o->waiters, 1, __ATOMIC_RELAXED);
+    sync_give(t->sync);
+
+    return rv;
+}
+
+static eswb_rv_t fifo_lockfree_push(topic_t *t, void *data, eswb_size_t elem_num) {
+    eswb_rv_t rv = topic_mem_write_fifo(t, data, elem_num);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&t->sync_owner->waiters, __ATOMIC_RELAXED) > 0) {
+        sync_take(t->sync);
+        topic_sync_wake(t);
+        sync_give(t->sync);
+    } else {
+        topic_stats_inc(&t->stats.wakeups_skipped);
+    }
+
+    return rv;
+}
+
 static eswb_rv_t fifo_wait_and_read(topic_t *t, fifo_rcvr_state_t *rcvr_state, void *data, int synced, int do_wait,
                                     uint32_t timeout_us) {
     eswb_rv_t rv = eswb_e_ok;
 
     do {
-        int32_t dlap = fifo_index_delta(t->fifo_ext->state.lap_num,  rcvr_state->lap, ESWB_FIFO_INDEX_OVERFLOW);
-        int32_t dind = t->fifo_ext->state.head - rcvr_state->tail;
-
-        if ( (dlap > 1) || ((dlap == 1) && (dind >= 0)) ) {
+        if (fifo_rcvr_is_lapped(&t->fifo_ext->state, rcvr_state)) {
             rv = eswb_e_fifo_rcvr_underrun;
             rcvr_state->lap = t->fifo_ext->state.lap_num-1;
             rcvr_state->tail = t->fifo_ext->state.head;
@@ -75,11 +309,7 @@ static eswb_rv_t fifo_wait_and_read(topic_t *t, fifo_rcvr_state_t *rcvr_state, v
             if (do_wait && synced) {
                 int wait_cnt = 0;
                 do {
-                    if (timeout_us > 0) {
-                        rv = sync_wait_timed(t->sync, timeout_us);
-                    } else {
-                        rv = sync_wait(t->sync);
-                    }
+                    rv = topic_sync_wait(t, timeout_us);
                     wait_cnt++;
                     // here we got an issue (under free rtos) when we've got a return from wait when there is no broadcast
                     // this cycle allowes fifos to be more robust
@@ -97,11 +327,7 @@ static eswb_rv_t fifo_wait_and_read(topic_t *t, fifo_rcvr_state_t *rcvr_state, v
 
         topic_mem_read_fifo(t, rcvr_state->tail, data);
 
-        rcvr_state->tail++;
-        if (rcvr_state->tail >= t->fifo_ext->fifo_size) {
-            rcvr_state->tail = 0;
-            rcvr_state->lap++;
-        }
+        fifo_rcvr_advance(t, rcvr_state, 1);
         // printf("%s | %p %p after pop result l = %d t = %d\n", __func__, rcvr_state, pthread_self(), rcvr_state->lap, rcvr_state->tail);
 
     } while (0);
@@ -110,14 +336,27 @@ static eswb_rv_t fifo_wait_and_read(topic_t *t, fifo_rcvr_state_t *rcvr_state, v
 }
 
 
+static int topic_is_conflating_evq(topic_t *t) {
+    return t->flags & TOPIC_FLAG_CONFLATING;
+}
+
 static eswb_rv_t fifo_flush(topic_t *t, fifo_rcvr_state_t *rcvr_state) {
 
     if (t->fifo_ext == NULL) {
         return eswb_e_not_fifo;
     }
 
-    rcvr_state->lap = t->fifo_ext->state.lap_num;
-    rcvr_state->tail = t->fifo_ext->state.head;
+    if (topic_is_conflating_evq(t)) {
+        rcvr_state->seq = t->fifo_ext->evq_seq;
+        rcvr_state->tail = 0;
+        return eswb_e_ok;
+    }
+
+    topic_fifo_state_t s;
+    topic_mem_fifo_get_state(t, &s);
+
+    rcvr_state->lap = s.lap_num;
+    rcvr_state->tail = s.head;
 
     return eswb_e_ok;
 }
@@ -125,19 +364,83 @@ static eswb_rv_t fifo_flush(topic_t *t, fifo_rcvr_state_t *rcvr_state) {
 
 eswb_rv_t
 topic_io_fifo_pop(topic_t *t, fifo_rcvr_state_t *rcvr_state, void *data, int synced, int do_wait, uint32_t timeout_us) {
+    if (synced && topic_is_lockfree_fifo(t)) {
+        return fifo_lockfree_pop(t, rcvr_state, data, do_wait, timeout_us);
+    }
+
     if (synced) sync_take(t->sync);
     eswb_rv_t rv = fifo_wait_and_read(t, rcvr_state, data, synced, do_wait, timeout_us);
     if (synced) sync_give(t->sync);
     return rv;
 }
 
+/**
+ * Pop up to max elements under a single lock; waits for the first element only
+ */
+eswb_rv_t topic_io_fifo_pop_n(topic_t *t, fifo_rcvr_state_t *rcvr_state, void *data, eswb_size_t max, eswb_size_t *got,
+                              int synced, int do_wait, uint32_t timeout_us) {
+    eswb_rv_t rv;
+    eswb_size_t elem_size = t->fifo_ext->elem_size;
+
+    *got = 0;
+
+    if (max == 0) {
+        return eswb_e_invargs;
+    }
+
+    if (synced && topic_is_lockfree_fifo(t)) {
+        rv = fifo_lockfree_pop(t, rcvr_state, data, do_wait, timeout_us);
+        if ((rv == eswb_e_ok) || (rv == eswb_e_fifo_rcvr_underrun)) {
+            eswb_size_t n;
+            for (n = 1; n < max; n++) {
+                eswb_rv_t nrv = fifo_lockfree_try_read(t, rcvr_state, data + elem_size * n);
+                if (nrv == eswb_e_no_update) {
+                    break;
+                }
+                if (nrv == eswb_e_fifo_rcvr_underrun) {
+                    rv = nrv;
+                }
+            }
+            *got = n;
+        }
+        return rv;
+    }
+
+    if (synced) sync_take(t->sync);
+
+    rv = fifo_wait_and_read(t, rcvr_state, data, synced, do_wait, timeout_us);
+    if ((rv == eswb_e_ok) || (rv == eswb_e_fifo_rcvr_underrun)) {
+        eswb_size_t n = fifo_rcvr_available(t, rcvr_state);
+        if (n > max - 1) {
+            n = max - 1;
+        }
+        topic_mem_read_fifo_n(t, rcvr_state->tail, data + elem_size, n);
+        fifo_rcvr_advance(t, rcvr_state, n);
+        *got = n + 1;
+    }
+
+    if (synced) sync_give(t->sync);
+
+    return rv;
+}
+
 eswb_rv_t topic_io_fifo_flush(topic_t *t, fifo_rcvr_state_t *rcvr_state, int synced) {
+    if (topic_is_lockfree_fifo(t)) {
+        return fifo_flush(t, rcvr_state);
+    }
+
     if (synced) sync_take(t->sync);
     eswb_rv_t rv = fifo_flush(t, rcvr_state);
     if (synced) sync_give(t->sync);
     return rv;
 }
 
+/**
+ * Replicated events keep numbering of their origin bus, so consumers of the replica detect events lost on the link
+ */
+static uint32_t event_delivered_seq(const event_queue_record_t *r) {
+    return r->origin_seq != 0 ? r->origin_seq : r->seq;
+}
 
 eswb_rv_t topic_io_event_queue_pop(topic_t *t, eswb_event_queue_mask_t mask, fifo_rcvr_state_t *rcvr_state,
                                    event_queue_transfer_t *eqt, int synced, uint32_t timeout_us) {
@@ -189,20 +492,124 @@ eswb_rv_t topic_io_event_queue_pop(topic_t *t, eswb_event_queue_mask_t mask, fif
         eqt->size = event.size;
         eqt->topic_id = event.topic_id;
         eqt->type = event.type;
+        eqt->seq = event_delivered_seq(&event);
+        eqt->timestamp = event.timestamp;
         rv = topic_mem_event_queue_get_data(t, &event, EVENT_QUEUE_TRANSFER_DATA(eqt));
     }
 
     return rv;
 }
 
-eswb_rv_t topic_io_do_update(topic_t *t, eswb_update_t ut, void *data, int synced) {
+/**
+ * Pop the oldest of events not popped yet from conflating event queue. Every topic has its latest event only,
+ * so slow consumer skips outdated updates instead of underrunning.
+ */
+eswb_rv_t topic_io_event_queue_conflated_pop(topic_t *t, eswb_event_queue_mask_t mask, fifo_rcvr_state_t *rcvr_state,
+                                             event_queue_transfer_t *eqt, int synced, uint32_t timeout_us) {
+    eswb_rv_t rv = eswb_e_ok;
+    event_queue_slot_t *s;
+
+    if (synced) sync_take(t->sync);
+    do {
+        while (t->fifo_ext->evq_seq == rcvr_state->seq) {
+            rv = synced ? topic_sync_wait(t, timeout_us) : eswb_e_no_update;
+            if (rv != eswb_e_ok) {
+                break;
+            }
+        }
+        if (rv != eswb_e_ok) {
+            break;
+        }
+
+        eswb_index_t ref = topic_mem_event_queue_next_slot(t, rcvr_state->tail, rcvr_state->seq);
+        s = topic_mem_event_queue_slot(t, ref);
+        rcvr_state->tail = ref;
+        rcvr_state->seq = s->rec.seq;
+    } while (synced && ((s->rec.ch_mask & mask) == 0));
+
+    if (rv == eswb_e_ok) {
+        eqt->size = s->rec.size;
+        eqt->topic_id = s->rec.topic_id;
+        eqt->type = s->rec.type;
+        eqt->seq = event_delivered_seq(&s->rec);
+        eqt->timestamp = s->rec.timestamp;
+        // slot is overwritten in place, so data is copied under the sync
+        rv = topic_mem_event_queue_get_data(t, &s->rec, EVENT_QUEUE_TRANSFER_DATA(eqt));
+    }
+    if (synced) sync_give(t->sync);
+
+    return rv;
+}
+
+/**
+ * Pop event of a single channel from its sub-queue, events of other channels are not touched at all
+ * @param subq sub-queue of the event queue, holds positions of channel's records in evq
+ * @return eswb_e_fifo_rcvr_underrun if some events of the channel were lost, event is returned anyway
+ */
+eswb_rv_t topic_io_event_subqueue_pop(topic_t *evq, topic_t *subq, fifo_rcvr_state_t *rcvr_state,
+                                      event_queue_transfer_t *eqt, int synced, uint32_t timeout_us) {
+    eswb_rv_t rv;
+    int lost = 0;
+
+    topic_fifo_state_t pos;
+    event_queue_record_t event;
+
+    if (synced) sync_take(evq->sync);
+    do {
+        rv = fifo_wait_and_read(subq, rcvr_state, &pos, synced, 1, timeout_us);
+        if (rv == eswb_e_fifo_rcvr_underrun) {
+            lost = -1;
+        } else if (rv != eswb_e_ok) {
+            break;
+        }
+
+        // record is overwritten in the event queue if receiver standing at its position is lapped
+        fifo_rcvr_state_t rec_pos = {.tail = pos.head, .lap = pos.lap_num};
+        if (fifo_rcvr_is_lapped(&evq->fifo_ext->state, &rec_pos)) {
+            lost = -1;
+            event.type = eqr_none;
+            continue;
+        }
+
+        topic_mem_read_fifo(evq, pos.head, &event);
+    } while (event.type == eqr_none);
+    if (synced) sync_give(evq->sync);
+
+    if ((rv == eswb_e_ok) || (rv == eswb_e_fifo_rcvr_underrun)) {
+        eqt->size = event.size;
+        eqt->topic_id = event.topic_id;
+        eqt->type = event.type;
+        eqt->seq = event_delivered_seq(&event);
+        eqt->timestamp = event.timestamp;
+        rv = topic_mem_event_queue_get_data(evq, &event, EVENT_QUEUE_TRANSFER_DATA(eqt));
+        if ((rv == eswb_e_ok) && lost) {
+            rv = eswb_e_fifo_rcvr_underrun;
+        }
+    }
+
+    return rv;
+}
+
+/**
+ *
+ * @param elem_num number of elements in data for upd_push_fifo (0 is treated as 1), ignored by other update types
+ */
+eswb_rv_t topic_io_do_update(topic_t *t, eswb_update_t ut, void *data, eswb_size_t elem_num, int synced) {
+
+    if ((ut == upd_push_fifo) && (elem_num == 0)) {
+        elem_num = 1;
+    }
+
+    if (synced && (ut == upd_push_fifo) && topic_is_lockfree_fifo(t)) {
+        return fifo_lockfree_push(t, data, elem_num);
+    }
 
     if (synced) sync_take(t->sync);
 
     eswb_rv_t  rv;
     switch (ut) {
         case upd_proclaim_topic:
-            rv = reg_tree_register(t->reg_ref, t, (topic_proclaiming_tree_t *) data, synced);
+            rv = reg_tree_register(topic_node(t)->reg_ref, t, (topic_proclaiming_tree_t *) data, synced);
             break;
 
         case upd_update_topic:
@@ -210,7 +617,7 @@ eswb_rv_t topic_io_do_update(topic_t *t, eswb_update_t ut, void *data, int synce
             break;
 
         case upd_push_fifo:
-            rv = topic_mem_write_fifo(t, data);
+            rv = topic_mem_write_fifo(t, data, elem_num);
             break;
 
         case upd_push_event_queue:
@@ -228,7 +635,7 @@ eswb_rv_t topic_io_do_update(topic_t *t, eswb_update_t ut, void *data, int synce
             // if (ut == upd_push_event_queue) {
             //     printf("%s upd_push_event_queue sync_broadcast\n", __func__);
             // }
-            sync_broadcast(t->sync);
+            topic_sync_wake(t);
         }
         sync_give(t->sync);
     }
@@ -236,6 +643,23 @@ eswb_rv_t topic_io_do_update(topic_t *t, eswb_update_t ut, void *data, int synce
     return rv;
 }
 
+/**
+ * Proclaim tree under t which root is mapped onto memory of alias topic, see reg_tree_register_alias
+ */
+eswb_rv_t topic_io_proclaim_alias(topic_t *t, topic_proclaiming_tree_t *tree, topic_t *alias, int synced) {
+    if (synced) sync_take(t->sync);
+
+    eswb_rv_t rv = reg_tree_register_alias(topic_node(t)->reg_ref, t, tree, alias, synced);
+
+    if (synced) {
+        if (rv == eswb_e_ok) {
+            topic_sync_wake(t);
+        }
+        sync_give(t->sync);
+    }
+
+    return rv;
+}
 
 eswb_rv_t topic_io_get_state (topic_t *t, topic_fifo_state_t *state, int synced) {
 
@@ -246,10 +670,174 @@ eswb_rv_t topic_io_get_state (topic_t *t, topic_fifo_state_t *state, int synced)
     if (t->fifo_ext == NULL) {
         rv = eswb_e_not_fifo;
     } else {
-        memcpy(state, &t->fifo_ext->state, sizeof(topic_fifo_state_t));
+        topic_mem_fifo_get_state(t, state);
     }
 
     if (synced) sync_give(t->sync);
 
     return rv;
 }
+
+
+static int topic_is_loanable(topic_t *t) {
+    return (t->fifo_ext == NULL) && (t->data != NULL) && (t->data_size > 0);
+}
+
+/**
+ * Give away pointer to topic's data for in place modification. Topic stays locked till topic_io_commit.
+ */
+eswb_rv_t topic_io_loan_write(topic_t *t, void **data, int synced) {
+    if (!topic_is_loanable(t)) {
+        return eswb_e_not_supported;
+    }
+
+    if (synced) sync_take(t->sync);
+
+    *data = topic_mem_write_begin(t);
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t topic_io_commit(topic_t *t, int synced) {
+    topic_mem_write_end(t);
+
+    if (synced) {
+        topic_sync_wake(t);
+        sync_give(t->sync);
+    }
+
+    return eswb_e_ok;
+}
+
+/**
+ * Give away pointer to topic's data for in place parsing. Publishers are blocked till topic_io_release.
+ * Not supported for triple buffered topics, as their publishers are never blocked by readers.
+ */
+eswb_rv_t topic_io_borrow_read(topic_t *t, void **data, int synced) {
+    if (!topic_is_loanable(t) || (t->flags & TOPIC_FLAG_TRIPLE_BUFFER)) {
+        return eswb_e_not_supported;
+    }
+
+    if (synced) sync_take(t->sync);
+
+    *data = t->data;
+
+    return eswb_e_ok;
+}
+
+eswb_rv_t topic_io_release(topic_t *t, int synced) {
+    if (synced) sync_give(t->sync);
+
+    return eswb_e_ok;
+}
+
+void topic_io_get_wakeup_hist(topic_t *t, topic_wakeup_hist_t *hist) {
+    for (int i = 0; i < ESWB_WAKEUP_HIST_BUCKETS; i++) {
+        hist->buckets[i] = __atomic_load_n(&topic_node(t)->wakeup_hist.buckets[i], __ATOMIC_RELAXED);
+    }
+}
+
+void topic_io_get_stats(topic_t *t, topic_stats_t *stats) {
+    stats->wakeups = __atomic_load_n(&t->stats.wakeups, __ATOMIC_RELAXED);
+    stats->wakeups_skipped = __atomic_load_n(&t->stats.wakeups_skipped, __ATOMIC_RELAXED);
+}
+
+eswb_rv_t topic_io_listener_init(topic_listener_t *l) {
+    l->ready_mask = 0;
+    l->event_fd = -1;
+    return sync_create(&l->sync);
+}
+
+/**
+ * Listener signalling eventfd instead of the sync, to be waited by poll/epoll/select
+ */
+eswb_rv_t topic_io_listener_init_pollfd(topic_listener_t *l) {
+#ifdef __linux__
+    l->ready_mask = 0;
+    l->sync = NULL;
+    l->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    return l->event_fd >= 0 ? eswb_e_ok : eswb_e_sync_init;
+#else
+    return eswb_e_not_supported;
+#endif
+}
+
+void topic_io_listener_deinit(topic_listener_t *l) {
+#ifdef __linux__
+    if (l->event_fd >= 0) {
+        close(l->event_fd);
+        return;
+    }
+#endif
+    sync_destroy(l->sync);
+}
+
+/**
+ * Wait till any of attached topics is updated
+ * @param pending_mask topics known to be ready before the wait, no waiting if nonzero
+ * @param timeout_us timeout in microseconds, 0 means no timeout
+ * @param ready_mask mask of ready topics' bits
+ */
+eswb_rv_t topic_io_listener_wait(topic_listener_t *l, uint32_t pending_mask, uint32_t timeout_us, uint32_t *ready_mask) {
+    eswb_rv_t rv = eswb_e_ok;
+
+    sync_take(l->sync);
+    l->ready_mask |= pending_mask;
+    while ((l->ready_mask == 0) && (rv == eswb_e_ok)) {
+        if (timeout_us > 0) {
+            rv = sync_wait_timed(l->sync, timeout_us);
+        } else {
+            rv = sync_wait(l->sync);
+        }
+    }
+    *ready_mask = l->ready_mask;
+    l->ready_mask = 0;
+    sync_give(l->sync);
+
+    return *ready_mask != 0 ? eswb_e_ok : rv;
+}
+
+/**
+ * Attach listener to the topic, so every update of it sets link's ready bit in the listener.
+ * Attached listener counts as a waiter.
+ */
+void topic_io_listener_attach(topic_t *t, topic_listener_link_t *link) {
+    topic_t *o = t->sync_owner;
+
+    sync_take(t->sync);
+    link->next = topic_node(o)->listeners;
+    topic_node(o)->listeners = link;
+    // lock-free FIFO producer checks waiters after publishing, caller checks FIFO state after attaching
+    __atomic_fetch_add(&o->waiters, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    sync_give(t->sync);
+}
+
+void topic_io_listener_detach(topic_t *t, topic_listener_link_t *link) {
+    topic_t *o = t->sync_owner;
+
+    sync_take(t->sync);
+    for (topic_listener_link_t **l = &topic_node(o)->listeners; *l != NULL; l = &(*l)->next) {
+        if (*l == link) {
+            *l = link->next;
+            break;
+        }
+    }
+    __atomic_fetch_sub(&o->waiters, 1, __ATOMIC_RELAXED);
+    sync_give(t->sync);
+}
+
+/**
+ * Check if FIFO or event queue receiver has elements to pop, underrun is also reported as pending
+ */
+int topic_io_fifo_pending(topic_t *t, const fifo_rcvr_state_t *rcvr_state) {
+    if (topic_is_conflating_evq(t)) {
+        return __atomic_load_n(&t->fifo_ext->evq_seq, __ATOMIC_RELAXED) != rcvr_state->seq;
+    }
+
+    topic_fifo_state_t s;
+    topic_mem_fifo_get_state(t, &s);
+
+    return fifo_rcvr_is_lapped(&s, rcvr_state) || (s.head != rcvr_state->tail);
+}
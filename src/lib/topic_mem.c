@@ -1,31 +1,208 @@
 #include <string.h>
 #include "topic_mem.h"
+#include "registry.h"
 #include "eswb/event_queue.h"
 
 
+/*
+ * Triple buffered topics keep three copies of data, seq of sync_owner counts published generations and
+ * generation's buffer is gen % 3. Writer fills the buffer of the next generation, so the one being read
+ * is overwritten only after two more publications.
+ */
+#define TB_BUFFERS 3
+#define TB_GEN_WRAP ((uint32_t) TB_BUFFERS << 30) // multiple of TB_BUFFERS, so buffers keep rotating over the wrap
+
+static int topic_mem_is_triple_buffered(topic_t *t) {
+    return t->flags & TOPIC_FLAG_TRIPLE_BUFFER;
+}
+
+eswb_size_t topic_mem_tb_stride(topic_t *t) {
+    return (t->data_size + TOPIC_CACHE_LINE - 1) & ~(TOPIC_CACHE_LINE - 1);
+}
+
+static uint32_t tb_next_gen(uint32_t gen) {
+    return gen + 1 < TB_GEN_WRAP ? gen + 1 : 0;
+}
+
+static uint32_t tb_gen_distance(uint32_t from, uint32_t to) {
+    return to >= from ? to - from : to + TB_GEN_WRAP - from;
+}
+
+static void *tb_buffer(topic_t *t, uint32_t gen) {
+    return t->data + (gen % TB_BUFFERS) * topic_mem_tb_stride(t->sync_owner);
+}
+
+static void *topic_mem_read_buffer(topic_t *t) {
+    if (topic_mem_is_triple_buffered(t)) {
+        return tb_buffer(t, __atomic_load_n(&t->sync_owner->seq, __ATOMIC_ACQUIRE));
+    }
+    return t->data;
+}
+
 eswb_rv_t topic_mem_simply_copy(topic_t *t, void *data) {
     if (data != NULL) {
-        memcpy(data, t->data, t->data_size);
+        memcpy(data, topic_mem_read_buffer(t), t->data_size);
     }
     return eswb_e_ok;
 }
 
 
+/**
+ * Seqlock read: copy data without taking the sync, retrying is up to the caller
+ * @return eswb_e_ok if copy is consistent, eswb_e_sync_inconsistent if writer interfered
+ */
+eswb_rv_t topic_mem_read_consistent(topic_t *t, void *data) {
+    topic_t *o = t->sync_owner;
+
+    uint32_t s1 = __atomic_load_n(&o->seq, __ATOMIC_ACQUIRE);
+
+    if (topic_mem_is_triple_buffered(t)) {
+        memcpy(data, tb_buffer(t, s1), t->data_size);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t s2 = __atomic_load_n(&o->seq, __ATOMIC_RELAXED);
+
+        // writer might have started to refill the copied buffer only after two more publications
+        return tb_gen_distance(s1, s2) < TB_BUFFERS - 1 ? eswb_e_ok : eswb_e_sync_inconsistent;
+    }
+
+    if (s1 & 1) {
+        return eswb_e_sync_inconsistent;
+    }
+
+    topic_mem_simply_copy(t, data);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t s2 = __atomic_load_n(&o->seq, __ATOMIC_RELAXED);
+
+    return s1 == s2 ? eswb_e_ok : eswb_e_sync_inconsistent;
+}
+
+/**
+ * Version of topic's data, changes on every write to the topic or to anything sharing its sync owner.
+ * Fence keeps data loaded before the call from being reordered after the version load.
+ */
+uint32_t topic_mem_version(topic_t *t) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&t->sync_owner->seq, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Buffer the next write goes to, for triple buffered topics it is not visible to readers till topic_mem_write_end
+ */
+void *topic_mem_write_buffer(topic_t *t) {
+    if (topic_mem_is_triple_buffered(t)) {
+        // writers are serialized by the sync, so nobody else moves the generation
+        return tb_buffer(t, tb_next_gen(t->sync_owner->seq));
+    }
+    return t->data;
+}
+
+/**
+ * Prepare data for modification
+ * @return pointer to write topic's data to
+ */
+void *topic_mem_write_begin(topic_t *t) {
+    topic_t *o = t->sync_owner;
+
+    if (topic_mem_is_triple_buffered(t)) {
+        // previous generation must be visible before its predecessor's buffer is overwritten
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        if (o != t) {
+            // member of the struct is updated, the rest of it is carried over from the latest generation
+            memcpy(topic_mem_write_buffer(o), tb_buffer(o, o->seq), o->data_size);
+        }
+        return topic_mem_write_buffer(t);
+    }
+
+    // writers are serialized by the sync, so plain read of seq is safe here
+    __atomic_store_n(&o->seq, o->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    return t->data;
+}
+
+void topic_mem_write_end(topic_t *t) {
+    topic_t *o = t->sync_owner;
+
+    if (topic_mem_is_triple_buffered(t)) {
+        __atomic_store_n(&o->seq, tb_next_gen(o->seq), __ATOMIC_RELEASE);
+        return;
+    }
+
+    __atomic_store_n(&o->seq, o->seq + 1, __ATOMIC_RELEASE);
+}
+
 eswb_rv_t topic_mem_write(topic_t *t, void *data) {
-    memcpy(t->data, data, t->data_size);
+    void *dst = topic_mem_write_begin(t);
+    memcpy(dst, data, t->data_size);
+    topic_mem_write_end(t);
+
     return eswb_e_ok;
 }
 
 #include <stdio.h>
 
-eswb_rv_t topic_mem_write_fifo(topic_t *t, void *data) {
+static eswb_size_t fifo_contiguous_run(fifo_ext_t *f, eswb_index_t from, eswb_size_t num) {
+    eswb_size_t till_end = f->fifo_size - from;
+    return num < till_end ? num : till_end;
+}
+
+/**
+ * Copy elements to slots starting from 'from', wrapping around the end of the buffer
+ */
+static void fifo_store_run(topic_t *t, eswb_index_t from, const void *data, eswb_size_t num) {
+    fifo_ext_t *f = t->fifo_ext;
+
+    if (f->elem_step == f->elem_size) {
+        eswb_size_t run = fifo_contiguous_run(f, from, num);
+        memcpy(t->data + f->elem_step * from, data, f->elem_size * run);
+        if (run < num) {
+            memcpy(t->data, data + f->elem_size * run, f->elem_size * (num - run));
+        }
+    } else {
+        for (eswb_size_t i = 0; i < num; i++) {
+            memcpy(t->data + f->elem_step * ((from + i) % f->fifo_size), data + f->elem_size * i, f->elem_size);
+        }
+    }
+}
+
+static void fifo_advance_state(fifo_ext_t *f, topic_fifo_state_t *s, eswb_size_t num) {
+    eswb_size_t pos = s->head + num;
+    s->head = pos % f->fifo_size;
+    s->lap_num += pos / f->fifo_size;
+}
 
-    memcpy(t->data + t->fifo_ext->elem_step * t->fifo_ext->state.head, data, t->fifo_ext->elem_size);
+/**
+ * Push elements to fifo. Head and lap are published at once after elements are stored, so lock-free readers
+ * never observe intermediate state. Still requires pushes to be serialized.
+ * @param num number of elements stored contiguously in data
+ */
+eswb_rv_t topic_mem_write_fifo(topic_t *t, void *data, eswb_size_t num) {
+
+    fifo_ext_t *f = t->fifo_ext;
+    topic_fifo_state_t s = f->state;
+
+    if (num > f->fifo_size) {
+        // only the last fifo_size elements survive anyway
+        fifo_advance_state(f, &s, num - f->fifo_size);
+        data += f->elem_size * (num - f->fifo_size);
+        num = f->fifo_size;
+    }
 
-    t->fifo_ext->state.head++;
-    if (t->fifo_ext->state.head >= t->fifo_ext->fifo_size) {
-        t->fifo_ext->state.head = 0;
-        t->fifo_ext->state.lap_num++;
+    if (t->sync_owner->flags & TOPIC_FLAG_LOCKFREE_FIFO) {
+        // lock-free readers detect overwriting of the slot at head only, so publish element by element
+        for (eswb_size_t i = 0; i < num; i++) {
+            // previously published state must be visible before the slot is overwritten
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            memcpy(t->data + f->elem_step * s.head, data + f->elem_size * i, f->elem_size);
+            fifo_advance_state(f, &s, 1);
+            __atomic_store(&f->state, &s, __ATOMIC_RELEASE);
+        }
+    } else {
+        fifo_store_run(t, s.head, data, num);
+        fifo_advance_state(f, &s, num);
+        __atomic_store(&f->state, &s, __ATOMIC_RELEASE);
     }
 
     // printf("%s | fifo after update l = %d h = %d)\n", __func__,
@@ -40,10 +217,33 @@ void topic_mem_read_fifo(topic_t *t, eswb_index_t tail, void *data) {
 
 }
 
+/**
+ * Copy num elements starting from tail, wrapping around the end of the buffer
+ */
+void topic_mem_read_fifo_n(topic_t *t, eswb_index_t tail, void *data, eswb_size_t num) {
+    fifo_ext_t *f = t->fifo_ext;
+
+    if (f->elem_step == f->elem_size) {
+        eswb_size_t run = fifo_contiguous_run(f, tail, num);
+        memcpy(data, t->data + f->elem_step * tail, f->elem_size * run);
+        if (run < num) {
+            memcpy(data + f->elem_size * run, t->data, f->elem_size * (num - run));
+        }
+    } else {
+        for (eswb_size_t i = 0; i < num; i++) {
+            topic_mem_read_fifo(t, (tail + i) % f->fifo_size, data + f->elem_size * i);
+        }
+    }
+}
+
+void topic_mem_fifo_get_state(topic_t *t, topic_fifo_state_t *state) {
+    __atomic_load(&t->fifo_ext->state, state, __ATOMIC_ACQUIRE);
+}
+
 eswb_rv_t topic_mem_get_params(topic_t *t, topic_params_t *params) {
-    strncpy(params->name, t->name, ESWB_TOPIC_NAME_MAX_LEN);
-    if (t->parent != NULL) {
-        strncpy(params->parent_name, t->parent->name, ESWB_TOPIC_NAME_MAX_LEN);
+    strncpy(params->name, topic_node(t)->name, ESWB_TOPIC_NAME_MAX_LEN);
+    if (topic_node(t)->parent != NULL) {
+        strncpy(params->parent_name, topic_node(topic_node(t)->parent)->name, ESWB_TOPIC_NAME_MAX_LEN);
     }
 
     params->type = t->type;
@@ -101,7 +301,49 @@ void *topic_write_byte_buffer(topic_t *t, void *data, eswb_size_t size) {
 }
 
 static topic_t *event_queue_get_buffer(topic_t *evq) {
-    return evq->first_child->next_sibling; // hangs on slippery convention that buffer is the second member ...
+    return topic_node(topic_node(evq)->first_child)->next_sibling; // hangs on slippery convention that buffer is the second member ...
+}
+
+/*
+ * Sub-queues follow the buffer as the event queue's children, one per channel of evq_subch_mask in ascending
+ * order. They are FIFOs of positions of the records in the event queue, so consumer of a single channel
+ * touches only the records of its channel.
+ */
+static topic_t *event_queue_first_subch(topic_t *evq) {
+    return topic_node(event_queue_get_buffer(evq))->next_sibling;
+}
+
+/**
+ * Get sub-queue carrying events of the mask
+ * @return NULL if mask is not a single channel or the channel has no sub-queue
+ */
+topic_t *topic_mem_event_queue_subch(topic_t *evq, eswb_event_queue_mask_t mask) {
+    eswb_event_queue_mask_t subch = evq->fifo_ext->evq_subch_mask;
+
+    if ((mask == 0) || ((mask & (mask - 1)) != 0) || !(subch & mask)) {
+        return NULL;
+    }
+
+    topic_t *sq = event_queue_first_subch(evq);
+    for (; (subch & (~subch + 1)) != mask; subch &= subch - 1) {
+        sq = topic_node(sq)->next_sibling;
+    }
+
+    return sq;
+}
+
+static void event_queue_push_to_subch(topic_t *evq, eswb_event_queue_mask_t ch_mask, topic_fifo_state_t *pos) {
+    eswb_event_queue_mask_t subch = evq->fifo_ext->evq_subch_mask;
+
+    if (!(subch & ch_mask)) {
+        return;
+    }
+
+    for (topic_t *sq = event_queue_first_subch(evq); subch != 0; subch &= subch - 1, sq = topic_node(sq)->next_sibling) {
+        if (ch_mask & subch & (~subch + 1)) {
+            topic_mem_write_fifo(sq, pos, 1);
+        }
+    }
 }
 
 eswb_rv_t topic_mem_event_queue_get_data(topic_t *evq, event_queue_record_t *event, void *data) {
@@ -110,20 +352,142 @@ eswb_rv_t topic_mem_event_queue_get_data(topic_t *evq, event_queue_record_t *eve
     return topic_read_byte_buffer(buff, event->data, data, event->size);
 }
 
-#define YES (-1)
+/**
+ * Invalidate records which data is going to be overwritten by the next write to the buffer. Records data goes
+ * to the buffer in the same order as records go to the queue, so only the oldest of live records might be hit,
+ * every record is checked until it is overwritten once and the cost is amortized O(1) per write.
+ */
+static void event_queue_invalidate_overrun(topic_t *t, topic_t *data_buf_topic, eswb_size_t write_size) {
+    fifo_ext_t *f = t->fifo_ext;
+    eswb_size_t buf_size = data_buf_topic->fifo_ext->fifo_size;
+    eswb_index_t write_pos = data_buf_topic->fifo_ext->state.head;
+
+    while (f->evq_data_live > 0) {
+        eswb_index_t oldest = (f->state.head + f->fifo_size - f->evq_data_live) % f->fifo_size;
+        event_queue_record_t *rec = (event_queue_record_t *) topic_fifo_access_by_index(t, oldest);
+
+        if (rec->size > 0) {
+            // distance from the write position forward to the record's data, zero means it is a full buffer behind
+            eswb_size_t ahead = (rec->data - data_buf_topic->data + buf_size - write_pos) % buf_size;
+            if (ahead >= write_size) {
+                break;
+            }
+            rec->type = eqr_none;
+            rec->ch_mask = 0;
+        }
+
+        f->evq_data_live--;
+    }
+}
+
+event_queue_slot_t *topic_mem_event_queue_slot(topic_t *evq, eswb_index_t ref) {
+    return (event_queue_slot_t *) topic_fifo_access_by_index(evq, ref - 1);
+}
+
+static void event_queue_slot_unlink(topic_t *evq, eswb_index_t ref) {
+    fifo_ext_t *f = evq->fifo_ext;
+    event_queue_slot_t *s = topic_mem_event_queue_slot(evq, ref);
+
+    if (s->prev) {
+        topic_mem_event_queue_slot(evq, s->prev)->next = s->next;
+    } else {
+        f->evq_oldest = s->next;
+    }
+
+    if (s->next) {
+        topic_mem_event_queue_slot(evq, s->next)->prev = s->prev;
+    } else {
+        f->evq_newest = s->prev;
+    }
+}
+
+static void event_queue_slot_append(topic_t *evq, eswb_index_t ref) {
+    fifo_ext_t *f = evq->fifo_ext;
+    event_queue_slot_t *s = topic_mem_event_queue_slot(evq, ref);
+
+    s->prev = f->evq_newest;
+    s->next = 0;
+
+    if (f->evq_newest) {
+        topic_mem_event_queue_slot(evq, f->evq_newest)->next = ref;
+    } else {
+        f->evq_oldest = ref;
+    }
+    f->evq_newest = ref;
+}
+
+static int event_queue_seq_after(uint32_t seq, uint32_t than) {
+    return (int32_t) (seq - than) > 0;
+}
+
+/**
+ * Find slot of the oldest event after seq
+ * @param cursor slot the event of seq was popped from, its next slot is the answer until the slot gets a newer event
+ * @return 0 if there are no newer events
+ */
+eswb_index_t topic_mem_event_queue_next_slot(topic_t *evq, eswb_index_t cursor, uint32_t seq) {
+    if ((cursor != 0) && (topic_mem_event_queue_slot(evq, cursor)->rec.seq == seq)) {
+        return topic_mem_event_queue_slot(evq, cursor)->next;
+    }
+
+    // cursor's slot moved to the end, walk back over the events which are not popped yet
+    eswb_index_t ref = evq->fifo_ext->evq_newest;
+    if ((ref == 0) || !event_queue_seq_after(topic_mem_event_queue_slot(evq, ref)->rec.seq, seq)) {
+        return 0;
+    }
+
+    for (eswb_index_t p = topic_mem_event_queue_slot(evq, ref)->prev;
+         (p != 0) && event_queue_seq_after(topic_mem_event_queue_slot(evq, p)->rec.seq, seq);
+         p = topic_mem_event_queue_slot(evq, p)->prev) {
+        ref = p;
+    }
+
+    return ref;
+}
+
+static eswb_rv_t event_queue_conflate(topic_t *t, topic_t *data_buf_topic, const event_queue_record_t *r) {
+    fifo_ext_t *f = t->fifo_ext;
+    eswb_index_t *key = NULL;
+    eswb_index_t ref = 0;
+
+    // every proclamation is a new topic, updates and pushes are keyed by their topic
+    if (r->type != eqr_topic_proclaim) {
+        key = &topic_node(reg_topic(topic_node(t)->reg_ref, r->topic_id))->evq_slot;
+        ref = *key;
+    }
+
+    event_queue_slot_t *s;
 
-static inline int ptr_crosses_record(event_queue_record_t *r, void *buffer_origin, eswb_size_t buffer_size, void *ptr) {
+    if (ref == 0) {
+        if ((f->evq_slots_used >= f->fifo_size) || (r->size > data_buf_topic->data_size - f->evq_data_used)) {
+            return eswb_e_mem_data_na;
+        }
 
-    ssize_t left_border = r->data - buffer_origin;
-    ssize_t right_border = left_border + r->size;
-    ssize_t p = ptr - buffer_origin;
+        ref = ++f->evq_slots_used;
+        s = topic_mem_event_queue_slot(t, ref);
+        s->capacity = r->size;
+        s->rec.data = data_buf_topic->data + f->evq_data_used;
+        f->evq_data_used += r->size;
 
-    if (right_border > buffer_size) {
-        left_border -= buffer_size;
-        right_border -= buffer_size;
+        if (key != NULL) {
+            *key = ref;
+        }
+    } else {
+        s = topic_mem_event_queue_slot(t, ref);
+        if (r->size > s->capacity) {
+            return eswb_e_ev_queue_payload_too_large;
+        }
+        event_queue_slot_unlink(t, ref);
     }
 
-    return (p > left_border) && (p < right_border) ? YES : 0;
+    void *data = s->rec.data;
+    s->rec = *r;
+    s->rec.data = data;
+    memcpy(data, r->data, r->size);
+
+    event_queue_slot_append(t, ref);
+
+    return eswb_e_ok;
 }
 
 eswb_rv_t topic_mem_event_queue_write(topic_t *t, const event_queue_record_t *r) {
@@ -135,36 +499,33 @@ eswb_rv_t topic_mem_event_queue_write(topic_t *t, const event_queue_record_t *r)
     }
 
     event_queue_record_t rts = *r;
+    rts.seq = t->fifo_ext->evq_seq + 1;
+
+    if (t->flags & TOPIC_FLAG_CONFLATING) {
+        eswb_rv_t rv = event_queue_conflate(t, data_buf_topic, &rts);
+        if (rv == eswb_e_ok) {
+            t->fifo_ext->evq_seq = rts.seq;
+        }
+        return rv;
+    }
+
+    event_queue_invalidate_overrun(t, data_buf_topic, r->size);
+
     // push data
     // reposition data associated with event record
     rts.data = topic_write_byte_buffer(data_buf_topic, r->data, r->size);
 
-#   define CALC_INDEX(__i,__s) ((__i) > (__s) ? (__i) - (__s) : (__i))
+    topic_fifo_state_t pos = t->fifo_ext->state;
 
     // push event
-    topic_mem_write_fifo(t, &rts);
-    void *buffer_tail = data_buf_topic->data + data_buf_topic->fifo_ext->state.head;
-    uint32_t i = 0;
-
-    // TODO move this check to the receiver's site
-    event_queue_record_t *checking_record;
-//    while ( (checking_record = (event_queue_record_t *) topic_fifo_access_by_index(t, i + t->fifo_ext->state.head))
-//        // check data overlap with next elem
-//        //&& (checking_record->data != NULL)
-//        && (ptr_crosses_record(checking_record, data_buf_topic->data, data_buf_topic->data_size, buffer_tail) == YES)
-//        && (i <= t->data_size )) {
-//        // erase events in a queue if case of overlap
-//        checking_record->type = eqr_none;
-//        i++;
-//    }
-
-    for ( i = 0; i < t->data_size; i++) {
-        checking_record = (event_queue_record_t *) topic_fifo_access_by_index(t, i + t->fifo_ext->state.head);
-        if (ptr_crosses_record(checking_record, data_buf_topic->data,
-                               data_buf_topic->data_size, buffer_tail) == YES) {
-            checking_record->type = eqr_none;
-            checking_record->ch_mask = 0;
-        }
+    topic_mem_write_fifo(t, &rts, 1);
+    event_queue_push_to_subch(t, rts.ch_mask, &pos);
+
+    t->fifo_ext->evq_seq = rts.seq;
+
+    // record pushed out of the queue by this one is not tracked anymore
+    if (t->fifo_ext->evq_data_live < t->fifo_ext->fifo_size) {
+        t->fifo_ext->evq_data_live++;
     }
 
     return eswb_e_ok;
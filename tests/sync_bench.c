@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "sync.h"
+
+/*
+ * Microbenchmark of the sync backend linked in: posix_sync.c or futex_sync.c
+ */
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static void report(const char *name, double dt_ns, long ops) {
+    printf("%-36s %10.1f ns/op\n", name, dt_ns / (double) ops);
+}
+
+static void bench_take_give(long n) {
+    struct sync_handle *s;
+    sync_create(&s);
+
+    double t0 = now_ns();
+    for (long i = 0; i < n; i++) {
+        sync_take(s);
+        sync_give(s);
+    }
+    report("take/give uncontended", now_ns() - t0, n);
+
+    sync_destroy(s);
+}
+
+static void bench_broadcast_no_waiters(long n) {
+    struct sync_handle *s;
+    sync_create(&s);
+
+    double t0 = now_ns();
+    for (long i = 0; i < n; i++) {
+        sync_take(s);
+        sync_broadcast(s);
+        sync_give(s);
+    }
+    report("take/broadcast/give, no waiters", now_ns() - t0, n);
+
+    sync_destroy(s);
+}
+
+typedef struct {
+    struct sync_handle *s;
+    volatile long turn;
+    long n;
+    long counter;
+} shared_t;
+
+static void *pong_thread(void *arg) {
+    shared_t *sh = arg;
+
+    sync_take(sh->s);
+    for (long i = 0; i < sh->n; i++) {
+        while (sh->turn != 1) {
+            sync_wait(sh->s);
+        }
+        sh->turn = 0;
+        sync_broadcast(sh->s);
+    }
+    sync_give(sh->s);
+
+    return NULL;
+}
+
+static void bench_ping_pong(long n) {
+    shared_t sh = {.turn = 0, .n = n};
+    sync_create(&sh.s);
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, pong_thread, &sh);
+
+    double t0 = now_ns();
+    sync_take(sh.s);
+    for (long i = 0; i < n; i++) {
+        sh.turn = 1;
+        sync_broadcast(sh.s);
+        while (sh.turn != 0) {
+            sync_wait(sh.s);
+        }
+    }
+    sync_give(sh.s);
+    report("wait/broadcast ping-pong round trip", now_ns() - t0, n);
+
+    pthread_join(tid, NULL);
+    sync_destroy(sh.s);
+}
+
+static void *contender_thread(void *arg) {
+    shared_t *sh = arg;
+
+    for (long i = 0; i < sh->n; i++) {
+        sync_take(sh->s);
+        sh->counter++;
+        sync_give(sh->s);
+    }
+
+    return NULL;
+}
+
+static void bench_contended(long n, int threads_num) {
+    shared_t sh = {.n = n};
+    sync_create(&sh.s);
+
+    pthread_t tids[threads_num];
+
+    double t0 = now_ns();
+    for (int i = 0; i < threads_num; i++) {
+        pthread_create(&tids[i], NULL, contender_thread, &sh);
+    }
+    for (int i = 0; i < threads_num; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double dt = now_ns() - t0;
+
+    char name[64];
+    snprintf(name, sizeof(name), "take/give contended, %d threads", threads_num);
+    report(name, dt, n * threads_num);
+
+    if (sh.counter != n * threads_num) {
+        fprintf(stderr, "mutual exclusion violated: %ld != %ld\n", sh.counter, n * threads_num);
+        exit(1);
+    }
+
+    sync_destroy(sh.s);
+}
+
+int main(int argc, char *argv[]) {
+    long scale = argc > 1 ? atol(argv[1]) : 1;
+
+    bench_take_give(10000000 * scale);
+    bench_broadcast_no_waiters(10000000 * scale);
+    bench_ping_pong(100000 * scale);
+    bench_contended(1000000 * scale, 4);
+
+    return 0;
+}
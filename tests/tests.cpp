@@ -175,6 +175,334 @@ TEST_CASE("Basic Operations") {
 }
 
 
+TEST_CASE("Topic lookup") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 200);
+    REQUIRE(rv == eswb_e_ok);
+
+    // same names in different directories must not collide
+    for (int d = 0; d < 4; d++) {
+        std::string dir = "dir" + std::to_string(d);
+        rv = eswb_mkdir("itb:/bus", dir.c_str());
+        REQUIRE(rv == eswb_e_ok);
+
+        for (int i = 0; i < 30; i++) {
+            eswb_topic_descr_t td;
+            rv = eswb_proclaim_plain(("itb:/bus/" + dir).c_str(), ("t" + std::to_string(i)).c_str(), sizeof(uint32_t), &td);
+            REQUIRE(rv == eswb_e_ok);
+
+            uint32_t v = d * 1000 + i;
+            rv = eswb_update_topic(td, &v);
+            REQUIRE(rv == eswb_e_ok);
+        }
+    }
+
+    for (int d = 0; d < 4; d++) {
+        for (int i = 0; i < 30; i++) {
+            eswb_topic_descr_t td;
+            rv = eswb_connect(("itb:/bus/dir" + std::to_string(d) + "/t" + std::to_string(i)).c_str(), &td);
+            REQUIRE(rv == eswb_e_ok);
+
+            uint32_t v;
+            rv = eswb_read(td, &v);
+            REQUIRE(rv == eswb_e_ok);
+            CHECK(v == d * 1000 + i);
+        }
+    }
+
+    eswb_topic_descr_t td;
+    rv = eswb_connect("itb:/bus/dir0/t30", &td);
+    CHECK(rv == eswb_e_no_topic);
+
+    rv = eswb_connect("itb:/bus/t0", &td);
+    CHECK(rv == eswb_e_no_topic);
+}
+
+TEST_CASE("Lookup while proclaiming") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 1000);
+    REQUIRE(rv == eswb_e_ok);
+
+#   define LOOKUP_STRUCTS_NUM 300
+    struct structure {
+        uint32_t a;
+        uint32_t b;
+    };
+
+    std::thread proclaimer([&] () {
+        for (int i = 0; i < LOOKUP_STRUCTS_NUM; i++) {
+            TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 3);
+            structure st = {0};
+            topic_proclaiming_tree_t *rt = usr_topic_set_struct(cntx, st, ("s" + std::to_string(i)).c_str());
+            usr_topic_add_struct_child(cntx, rt, struct structure, a, "a", tt_uint32);
+            usr_topic_add_struct_child(cntx, rt, struct structure, b, "b", tt_uint32);
+            eswb_proclaim_tree_by_path("itb:/bus", rt, cntx->t_num, NULL);
+        }
+    });
+
+    std::atomic<int> partial_trees(0);
+    auto connector = [&] () {
+        for (int i = 0; i < LOOKUP_STRUCTS_NUM; i++) {
+            std::string path = "itb:/bus/s" + std::to_string(i);
+            eswb_topic_descr_t td;
+            while (eswb_connect(path.c_str(), &td) != eswb_e_ok);
+            eswb_disconnect(td);
+
+            // struct is visible along with all its members
+            if (eswb_connect((path + "/b").c_str(), &td) == eswb_e_ok) {
+                eswb_disconnect(td);
+            } else {
+                partial_trees++;
+            }
+        }
+    };
+
+    std::thread c1(connector);
+    std::thread c2(connector);
+
+    proclaimer.join();
+    c1.join();
+    c2.join();
+
+    bus_stats_t stats;
+    eswb_topic_descr_t root_td;
+    rv = eswb_connect("itb:/bus", &root_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_get_bus_stats(root_td, &stats);
+    REQUIRE(rv == eswb_e_ok);
+
+    CHECK(partial_trees == 0);
+    CHECK(stats.topics_num == 1 + LOOKUP_STRUCTS_NUM * 3);
+}
+
+TEST_CASE("Failed proclaim leaves nothing reachable") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 200);
+    REQUIRE(rv == eswb_e_ok);
+
+    // enough children to grow the name index while the tree is registered, the last one is rejected
+#   define FAILED_TREE_CHILDREN 80
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, FAILED_TREE_CHILDREN + 2);
+    topic_proclaiming_tree_t *rt = usr_topic_set_root(cntx, "d", tt_dir, 0);
+    for (int i = 0; i < FAILED_TREE_CHILDREN; i++) {
+        usr_topic_add_child(cntx, rt, ("c" + std::to_string(i)).c_str(), tt_uint32, 0, sizeof(uint32_t), 0);
+    }
+    usr_topic_add_child(cntx, rt, "bad", tt_dir, 0, 0, TOPIC_FLAG_TRIPLE_BUFFER);
+
+    rv = eswb_proclaim_tree_by_path("itb:/bus", rt, cntx->t_num, NULL);
+    REQUIRE(rv == eswb_e_invargs);
+
+    eswb_topic_descr_t td;
+    rv = eswb_connect("itb:/bus/d", &td);
+    CHECK(rv == eswb_e_no_topic);
+    rv = eswb_connect("itb:/bus/d/c0", &td);
+    CHECK(rv == eswb_e_no_topic);
+
+    // valid tree of the same name is registered and found
+    TOPIC_TREE_CONTEXT_LOCAL_RESET(cntx);
+    rt = usr_topic_set_root(cntx, "d", tt_dir, 0);
+    usr_topic_add_child(cntx, rt, "c0", tt_uint32, 0, sizeof(uint32_t), 0);
+
+    rv = eswb_proclaim_tree_by_path("itb:/bus", rt, cntx->t_num, NULL);
+    REQUIRE(rv == eswb_e_ok);
+
+    rv = eswb_connect("itb:/bus/d/c0", &td);
+    CHECK(rv == eswb_e_ok);
+}
+
+TEST_CASE("Registry grows on demand") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 4096);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t first_td;
+    rv = eswb_proclaim_plain("itb:/bus", "first", sizeof(uint32_t), &first_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    bus_stats_t initial;
+    rv = eswb_get_bus_stats(first_td, &initial);
+    REQUIRE(rv == eswb_e_ok);
+    CHECK(initial.topics_num == 2);
+    // memory is not provisioned for all of max_topics
+    CHECK(initial.mem_used < 4096 * 32);
+
+    for (int i = 0; i < 300; i++) {
+        eswb_topic_descr_t td;
+        rv = eswb_proclaim_plain("itb:/bus", ("t" + std::to_string(i)).c_str(), sizeof(uint32_t), &td);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_disconnect(td);
+        REQUIRE(rv == eswb_e_ok);
+    }
+
+    bus_stats_t grown;
+    rv = eswb_get_bus_stats(first_td, &grown);
+    REQUIRE(rv == eswb_e_ok);
+    CHECK(grown.topics_num == 302);
+    CHECK(grown.mem_used > initial.mem_used);
+
+    // topics allocated before growth stay in place
+    uint32_t v = 5;
+    rv = eswb_update_topic(first_td, &v);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t td;
+    rv = eswb_connect("itb:/bus/first", &td);
+    REQUIRE(rv == eswb_e_ok);
+
+    uint32_t r = 0;
+    rv = eswb_read(td, &r);
+    REQUIRE(rv == eswb_e_ok);
+    CHECK(r == v);
+
+    rv = eswb_connect("itb:/bus/t299", &td);
+    CHECK(rv == eswb_e_ok);
+}
+
+TEST_CASE("Bus data arena") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create_with_arena("bus", eswb_inter_thread, 100, 32 * 1024);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t a_td;
+    rv = eswb_proclaim_plain("itb:/bus", "a", 1, &a_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t b_td;
+    rv = eswb_proclaim_plain("itb:/bus", "b", 1, &b_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    SECTION("Topics data don't share cache lines") {
+        void *a;
+        rv = eswb_topic_loan_write(a_td, &a);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_topic_commit(a_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        void *b;
+        rv = eswb_topic_loan_write(b_td, &b);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_topic_commit(b_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        CHECK(((uintptr_t) a % 64) == 0);
+        CHECK(((uintptr_t) b % 64) == 0);
+        CHECK(((uintptr_t) a / 64) != ((uintptr_t) b / 64));
+    }
+
+    SECTION("Exhausted arena") {
+        eswb_topic_descr_t td;
+        rv = eswb_proclaim_plain("itb:/bus", "large", 40 * 1024, &td);
+        CHECK(rv == eswb_e_mem_data_na);
+
+        rv = eswb_proclaim_plain("itb:/bus", "small", 4, &td);
+        CHECK(rv == eswb_e_ok);
+    }
+
+    SECTION("Deleted with the bus") {
+        rv = eswb_delete("itb:/bus");
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_create_with_arena("bus", eswb_inter_thread, 100, 32 * 1024);
+        REQUIRE(rv == eswb_e_ok);
+    }
+}
+
+TEST_CASE("Topic descriptors recycling") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_plain("itb:/bus", "a", sizeof(uint32_t), &publish_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    SECTION("Table grows beyond a chunk") {
+        std::vector<eswb_topic_descr_t> tds(2000);
+        for (auto &td : tds) {
+            rv = eswb_connect("itb:/bus/a", &td);
+            REQUIRE(rv == eswb_e_ok);
+        }
+
+        uint32_t v = 7;
+        rv = eswb_update_topic(publish_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+
+        for (auto td : tds) {
+            uint32_t r = 0;
+            rv = eswb_read(td, &r);
+            REQUIRE(rv == eswb_e_ok);
+            REQUIRE(r == v);
+        }
+
+        for (auto td : tds) {
+            rv = eswb_disconnect(td);
+            REQUIRE(rv == eswb_e_ok);
+        }
+    }
+
+    SECTION("Released descriptors are reused") {
+        eswb_topic_descr_t td;
+        rv = eswb_connect("itb:/bus/a", &td);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_disconnect(td);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_disconnect(td);
+        CHECK(rv == eswb_e_invargs);
+
+        eswb_topic_descr_t td2;
+        rv = eswb_connect("itb:/bus/a", &td2);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(td2 == td);
+    }
+
+    SECTION("Concurrent connect and disconnect") {
+        std::vector<std::thread> threads;
+        std::atomic<int> errors(0);
+
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&errors]() {
+                for (int j = 0; j < 100000; j++) {
+                    eswb_topic_descr_t td;
+                    if (eswb_connect("itb:/bus/a", &td) != eswb_e_ok) {
+                        errors++;
+                        return;
+                    }
+                    if (eswb_disconnect(td) != eswb_e_ok) {
+                        errors++;
+                        return;
+                    }
+                }
+            });
+        }
+
+        for (auto &th : threads) {
+            th.join();
+        }
+
+        CHECK(errors == 0);
+    }
+}
+
 TEST_CASE("Timed out eswb_get_update wait") {
 
     eswb_local_init(1);
@@ -265,483 +593,2481 @@ TEST_CASE("Timed out eswb_fifo_pop wait") {
     }
 }
 
-TEST_CASE("FIFO | nsb", "[unit]") {
+TEST_CASE("Lock-free read consistency") {
+    eswb_rv_t rv;
 
     eswb_local_init(1);
 
-    std::string bus_name("bus");
-    std::string bus_path = "nsb:/" + bus_name;
+    std::string bus_path = "itb:/bus";
 
-    eswb_rv_t rv = eswb_create(bus_name.c_str(), eswb_non_synced, 20);
+    rv = eswb_create("bus", eswb_inter_thread, 20);
     REQUIRE(rv == eswb_e_ok);
 
-    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 10);
-#   define FIFO_SIZE 10
-    topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", FIFO_SIZE);
-    usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32,
-                                                              0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
+#   define SEQ_TEST_ARR_LEN 64
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+    struct structure {
+        uint32_t arr[SEQ_TEST_ARR_LEN];
+    } st = {0};
+    topic_proclaiming_tree_t *rt = usr_topic_set_struct(cntx, st, "st");
 
-    eswb_topic_descr_t snd_td;
-    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, &snd_td);
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), rt, cntx->t_num, &publish_td);
     REQUIRE(rv == eswb_e_ok);
 
-    eswb_topic_descr_t rcv_td;
-    rv = eswb_fifo_subscribe( (bus_path + "/fifo/elem").c_str(), &rcv_td);
+    eswb_topic_descr_t subs_td;
+    rv = eswb_connect((bus_path + "/st").c_str(), &subs_td);
     REQUIRE(rv == eswb_e_ok);
 
-    SECTION("Single push and pop") {
-        uint32_t data_snd = 123;
-        uint32_t data_rcv;
-        rv = eswb_fifo_push(snd_td, &data_snd);
-        REQUIRE(rv == eswb_e_ok);
-
-        rv = eswb_fifo_pop(rcv_td, &data_rcv);
-        REQUIRE(rv == eswb_e_ok);
-        REQUIRE(data_snd == data_rcv);
-    }
+    std::atomic<bool> stop(false);
 
-    SECTION(std::string("push and pop N times; fifo size = ") + std::to_string(FIFO_SIZE) ) {
-        for (int intrctn_num = 6; intrctn_num < FIFO_SIZE * 2 + 4; intrctn_num += intrctn_num < FIFO_SIZE + 1 ? 1 : 2 ) {
-            SECTION(std::string("Push and pop ") + std::to_string(intrctn_num)) {
-                for (int i = 0; i < intrctn_num; i++) {
-                    uint32_t data_snd = intrctn_num + i;
-                    uint32_t data_rcv;
-                    rv = eswb_fifo_push(snd_td, &data_snd);
-                    REQUIRE(rv == eswb_e_ok);
+    std::thread writer([&] () {
+        structure w;
+        for (uint32_t v = 1; !stop.load(); v++) {
+            for (int i = 0; i < SEQ_TEST_ARR_LEN; i++) {
+                w.arr[i] = v;
+            }
+            eswb_update_topic(publish_td, &w);
+        }
+    });
 
-                    rv = eswb_fifo_pop(rcv_td, &data_rcv);
-                    REQUIRE(rv == eswb_e_ok);
-                    REQUIRE(data_snd == data_rcv);
-                }
+    int torn_reads = 0;
+    for (int n = 0; n < 200000; n++) {
+        structure r;
+        rv = eswb_read(subs_td, &r);
+        REQUIRE(rv == eswb_e_ok);
+        for (int i = 1; i < SEQ_TEST_ARR_LEN; i++) {
+            if (r.arr[i] != r.arr[0]) {
+                torn_reads++;
+                break;
             }
         }
     }
 
-    SECTION("Underrun detection") {
+    stop = true;
+    writer.join();
 
-#       define OVERRUN_MARGIN 4
-        for (int i = 0; i < FIFO_SIZE + OVERRUN_MARGIN; i++) {
-            uint32_t data_snd = i;
-            rv = eswb_fifo_push(snd_td, &data_snd);
-            REQUIRE(rv == eswb_e_ok);
-        }
+    REQUIRE(torn_reads == 0);
+}
 
-        uint32_t data_rcv;
-        rv = eswb_fifo_pop(rcv_td, &data_rcv);
-        CHECK(rv == eswb_e_fifo_rcvr_underrun);
-        CHECK(data_rcv == OVERRUN_MARGIN);
-        rv = eswb_fifo_pop(rcv_td, &data_rcv);
-        CHECK(rv == eswb_e_ok);
-        CHECK(data_rcv == OVERRUN_MARGIN + 1);
-    }
+TEST_CASE("Triple buffered topic") {
+    eswb_rv_t rv;
 
-    SECTION("Push N times, Pop M; N > M") {
+    eswb_local_init(1);
 
-        for (int pushes = 11; pushes < FIFO_SIZE * 2 + 4; pushes += pushes < FIFO_SIZE + 4 ? 1 : 2) {
-            SECTION(std::string("Push and pop ") + std::to_string(pushes)) {
-                for (int i = 0; i < pushes; i++) {
-                    uint32_t data_snd = i;
-                    rv = eswb_fifo_push(snd_td, &data_snd);
-                    REQUIRE(rv == eswb_e_ok);
-                }
+    eswb_type_t bus_type = GENERATE(eswb_inter_thread, eswb_non_synced);
+    std::string bus_path = std::string(eswb_get_bus_prefix(bus_type)) + "bus";
 
-                int pops = 0;
-                int underruns = 0;
+    rv = eswb_create("bus", bus_type, 20);
+    REQUIRE(rv == eswb_e_ok);
 
-                do {
-                    uint32_t data_rcv;
-                    rv = eswb_fifo_pop(rcv_td, &data_rcv);
-                    switch (rv) {
-                        case eswb_e_fifo_rcvr_underrun:
-                            underruns++;
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+    struct structure {
+        double a;
+        double b;
+    } st = {0};
+    topic_proclaiming_tree_t *rt = usr_topic_set_struct(cntx, st, "st");
+    rt->flags |= TOPIC_FLAG_TRIPLE_BUFFER;
+    usr_topic_add_struct_child(cntx, rt, struct structure, a, "a", tt_double);
+    usr_topic_add_struct_child(cntx, rt, struct structure, b, "b", tt_double);
 
-                        case eswb_e_ok:
-                            CHECK(data_rcv == pops + pushes - FIFO_SIZE);
-                            pops++;
-                            break;
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), rt, cntx->t_num, &publish_td);
+    REQUIRE(rv == eswb_e_ok);
 
-                        case eswb_e_no_update:
-                            break;
+    eswb_topic_descr_t subs_td;
+    rv = eswb_connect((bus_path + "/st").c_str(), &subs_td);
+    REQUIRE(rv == eswb_e_ok);
 
-                        default:
-                            FAIL(rv);
-                            break;
-                    }
+    SECTION("Update, member update and loan") {
+        structure w = {1.0, 2.0};
+        structure r;
 
-                    REQUIRE(pops <= FIFO_SIZE);
-                    REQUIRE(underruns <= 1);
-                } while (rv != eswb_e_no_update);
-                CHECK(pops == FIFO_SIZE);
-            }
-        }
-    }
-
-    SECTION("Fifo state's lap counter overflow") {
-#define INITIAL_LAG 4
-
-        int j;
-        for (int i = 0; i < INITIAL_LAG; i++) {
-            uint32_t data_snd = j++;
-            rv = eswb_fifo_push(snd_td, &data_snd);
+        for (int i = 0; i < 5; i++) {
+            w.a += 1.0;
+            rv = eswb_update_topic(publish_td, &w);
+            REQUIRE(rv == eswb_e_ok);
+            rv = eswb_read(subs_td, &r);
             REQUIRE(rv == eswb_e_ok);
+            CHECK(r.a == w.a);
+            CHECK(r.b == w.b);
         }
 
-        for (int k = 0; k < ESWB_FIFO_INDEX_OVERFLOW * 1.5; k++) {
-            for (int i = 0; i < FIFO_SIZE; i++) {
-                uint32_t data_snd = j++;
-                rv = eswb_fifo_push(snd_td, &data_snd);
-                REQUIRE(rv == eswb_e_ok);
+        eswb_topic_descr_t b_td;
+        rv = eswb_connect((bus_path + "/st/b").c_str(), &b_td);
+        REQUIRE(rv == eswb_e_ok);
 
-                uint32_t data_rcv;
-                rv = eswb_fifo_pop(rcv_td, &data_rcv);
-                REQUIRE(rv == eswb_e_ok);
-                REQUIRE(data_rcv == data_snd - INITIAL_LAG);
-            }
-        }
-    }
+        double b = 7.0;
+        rv = eswb_update_topic(b_td, &b);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_read(subs_td, &r);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(r.a == w.a);
+        CHECK(r.b == 7.0);
 
-    SECTION("FIFO flush" ) {
-        int num_op_pushs = GENERATE(1, 4, 8, 12);
+        void *wp;
+        rv = eswb_topic_loan_write(publish_td, &wp);
+        REQUIRE(rv == eswb_e_ok);
+        ((structure *) wp)->a = 1.5;
+        ((structure *) wp)->b = 2.5;
 
-        SECTION(std::to_string(num_op_pushs) + std::string(" pushes")) {
-            for (int push = 0; push < num_op_pushs; push++) {
-                uint32_t data_snd = push;
-                uint32_t data_rcv;
-                rv = eswb_fifo_push(snd_td, &data_snd);
-                REQUIRE(rv == eswb_e_ok);
+        // not published till commit
+        rv = eswb_read(subs_td, &r);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(r.b == 7.0);
 
-                rv = eswb_fifo_flush(rcv_td);
-                REQUIRE(rv == eswb_e_ok);
+        rv = eswb_topic_commit(publish_td);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_read(subs_td, &r);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(r.a == 1.5);
+        CHECK(r.b == 2.5);
 
-                rv = eswb_fifo_pop(rcv_td, &data_rcv);
-                REQUIRE(rv == eswb_e_no_update);
+        const void *rp;
+        rv = eswb_topic_borrow_read(subs_td, &rp);
+        CHECK(rv == eswb_e_not_supported);
+    }
 
-                // push one more time  and check that it is still working
-                rv = eswb_fifo_push(snd_td, &data_snd);
-                REQUIRE(rv == eswb_e_ok);
+    SECTION("Not applicable for fifo") {
+        TOPIC_TREE_CONTEXT_LOCAL_RESET(cntx);
+        topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", 4);
+        fifo_root->flags |= TOPIC_FLAG_TRIPLE_BUFFER;
+        usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32, 0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
 
-                rv = eswb_fifo_pop(rcv_td, &data_rcv);
-                REQUIRE(rv == eswb_e_ok);
-                REQUIRE(data_rcv == data_snd);
-            }
-        }
+        rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, NULL);
+        REQUIRE(rv == eswb_e_invargs);
     }
 }
 
+TEST_CASE("Triple buffered read consistency") {
+    eswb_rv_t rv;
 
-#include "topic_mem.h"
-#include "registry.h"
-#include "local_buses.h"
+    eswb_local_init(1);
 
-extern "C" eswb_rv_t local_bus_create_event_queue(eswb_bus_handle_t *bh, eswb_size_t events_num, eswb_size_t data_buf_size);
-extern "C" eswb_rv_t local_bus_create(const char *bus_name, local_bus_type_t type, eswb_size_t max_topics);
-extern "C" eswb_rv_t local_event_queue_update(eswb_bus_handle_t *bh, event_queue_record_t *record);
+    std::string bus_path = "itb:/bus";
 
-void setup_queue_record(event_queue_record_t *r, event_queue_record_type_t t, void *d, ssize_t s) {
-    r->size = s;
-    r->topic_id = 777;
-    r->ch_mask = 0xFFFFFFFF;
-    r->type = t;
-    r->data = d;
-}
+    rv = eswb_create("bus", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
 
-int compare_event_queue_transfer(event_queue_record_t *evqr, event_queue_transfer_t *evqt) {
+#   define TB_TEST_ARR_LEN 8192
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+    topic_proclaiming_tree_t *rt = usr_topic_set_root(cntx, "tile", tt_plain_data, TB_TEST_ARR_LEN * sizeof(uint32_t));
+    rt->flags |= TOPIC_FLAG_TRIPLE_BUFFER;
 
-    if (evqt->type == evqr->type) {
-        if (evqt->topic_id == evqr->topic_id) {
-            if (evqt->size == evqr->size) {
-                int rv = memcmp(evqr->data, EVENT_QUEUE_TRANSFER_DATA(evqt), evqt->size);
-                if (rv != 0) {
-                    uint8_t bufR[200];
-                    uint8_t bufT[200];
-                    for(int i = 0; i < evqt->size; i++) {
-                        bufR[i] = ((uint8_t*)evqr->data)[i];
-                        bufT[i] = EVENT_QUEUE_TRANSFER_DATA(evqt)[i];
-                    }
-                    return rv;
-                }
-                return 0;
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), rt, cntx->t_num, &publish_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t subs_td;
+    rv = eswb_connect((bus_path + "/tile").c_str(), &subs_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    std::atomic<bool> stop(false);
+    std::vector<uint32_t> w(TB_TEST_ARR_LEN);
+    std::vector<uint32_t> r(TB_TEST_ARR_LEN);
+
+    std::thread writer([&] () {
+        for (uint32_t v = 1; !stop.load(); v++) {
+            std::fill(w.begin(), w.end(), v);
+            eswb_update_topic(publish_td, w.data());
+        }
+    });
+
+    int torn_reads = 0;
+    uint32_t last = 0;
+    for (int n = 0; n < 20000; n++) {
+        rv = eswb_read(subs_td, r.data());
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(r[0] >= last);
+        last = r[0];
+        for (int i = 1; i < TB_TEST_ARR_LEN; i++) {
+            if (r[i] != r[0]) {
+                torn_reads++;
+                break;
             }
         }
     }
 
-    return -1;
-}
+    stop = true;
+    writer.join();
 
-TEST_CASE("Event queue io | local bus level", "[unit]") {
-#   define EVQ_TEST_BUS_NAME "evqtb"
-#   define EVQ_TEST_BUS_MAX_TOPICS 10
-#   define EVQ_QUEUE_SIZE 10
-#   define EVQ_DATA_BUF_SIZE 1000
+    REQUIRE(torn_reads == 0);
+}
 
+TEST_CASE("Topic data loan") {
     eswb_rv_t rv;
-    event_queue_transfer_t *eqt = NULL;
 
     eswb_local_init(1);
 
-    eqt = (event_queue_transfer_t *) calloc(1, EVQ_DATA_BUF_SIZE + sizeof(event_queue_transfer_t));
+    eswb_type_t bus_type = GENERATE(eswb_inter_thread, eswb_non_synced);
+    std::string bus_path = std::string(eswb_get_bus_prefix(bus_type)) + "bus";
 
-    rv = local_bus_create(EVQ_TEST_BUS_NAME, local_bus_t_nonsynced, EVQ_TEST_BUS_MAX_TOPICS);
+    rv = eswb_create("bus", bus_type, 20);
     REQUIRE(rv == eswb_e_ok);
 
-    eswb_bus_handle_t *bh;
-    rv = local_lookup_nsb(EVQ_TEST_BUS_NAME, &bh);
-    REQUIRE(rv == eswb_e_ok);
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+    struct structure {
+        double a;
+        double b;
+    } st = {0};
+    topic_proclaiming_tree_t *rt = usr_topic_set_struct(cntx, st, "st");
+    usr_topic_add_struct_child(cntx, rt, struct structure, a, "a", tt_double);
+    usr_topic_add_struct_child(cntx, rt, struct structure, b, "b", tt_double);
 
-    rv = local_bus_create_event_queue(bh, EVQ_QUEUE_SIZE, EVQ_DATA_BUF_SIZE);
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), rt, cntx->t_num, &publish_td);
     REQUIRE(rv == eswb_e_ok);
 
-    eswb_topic_descr_t event_queue_td;
-    std::string evq_path = std::string(EVQ_TEST_BUS_NAME) + std::string("/") + std::string(BUS_EVENT_QUEUE_NAME) + std::string("/event"); // DRY is CRYing
-    rv = local_bus_connect(bh, evq_path.c_str(), &event_queue_td);
+    eswb_topic_descr_t subs_td;
+    rv = eswb_connect((bus_path + "/st").c_str(), &subs_td);
     REQUIRE(rv == eswb_e_ok);
 
+    SECTION("Loan, commit and borrow") {
+        void *wp;
+        rv = eswb_topic_loan_write(publish_td, &wp);
+        REQUIRE(rv == eswb_e_ok);
 
-    char bulk_data[255];
-    for (int i = 0; i < sizeof(bulk_data); i++) {
-        bulk_data[i] = i;
+        auto ws = (structure *) wp;
+        ws->a = 1.5;
+        ws->b = 2.5;
+
+        rv = eswb_topic_commit(publish_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        const void *rp;
+        rv = eswb_topic_borrow_read(subs_td, &rp);
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(rp == wp);
+
+        auto rs = (const structure *) rp;
+        CHECK(rs->a == 1.5);
+        CHECK(rs->b == 2.5);
+
+        rv = eswb_topic_release(subs_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        structure st_rcv;
+        rv = eswb_read(subs_td, &st_rcv);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(st_rcv.a == 1.5);
+        CHECK(st_rcv.b == 2.5);
     }
 
-    event_queue_record_t evqr;
+    SECTION("Unbalanced calls") {
+        rv = eswb_topic_commit(publish_td);
+        REQUIRE(rv == eswb_e_invargs);
 
+        rv = eswb_topic_release(subs_td);
+        REQUIRE(rv == eswb_e_invargs);
 
-    SECTION("Pushing and checking events") {
+        void *wp;
+        rv = eswb_topic_loan_write(publish_td, &wp);
+        REQUIRE(rv == eswb_e_ok);
 
-        SECTION("Single usual") {
-            double test_val = 123.0;
-            setup_queue_record(&evqr, eqr_topic_update, &test_val, sizeof(test_val));
+        rv = eswb_topic_loan_write(publish_td, &wp);
+        REQUIRE(rv == eswb_e_invargs);
 
-            rv = local_event_queue_update(bh, &evqr);
-            REQUIRE(rv == eswb_e_ok);
-            rv = local_fifo_pop(event_queue_td, eqt, 1);
-            REQUIRE(rv == eswb_e_ok);
+        rv = eswb_topic_release(publish_td);
+        REQUIRE(rv == eswb_e_invargs);
 
-            REQUIRE(compare_event_queue_transfer(&evqr, eqt) == 0);
-        }
+        rv = eswb_topic_commit(publish_td);
+        REQUIRE(rv == eswb_e_ok);
+    }
 
-        SECTION("Single bulk") {
-            setup_queue_record(&evqr, eqr_topic_proclaim, bulk_data, sizeof(bulk_data));
+    SECTION("Disconnect ends the loan") {
+        void *wp;
+        rv = eswb_topic_loan_write(publish_td, &wp);
+        REQUIRE(rv == eswb_e_ok);
 
-            rv = local_event_queue_update(bh, &evqr);
-            REQUIRE(rv == eswb_e_ok);
-            rv = local_fifo_pop(event_queue_td, eqt, 1);
-            REQUIRE(rv == eswb_e_ok);
+        ((structure *) wp)->a = 3.5;
 
-            REQUIRE(compare_event_queue_transfer(&evqr, eqt) == 0);
-        }
+        rv = eswb_disconnect(publish_td);
+        REQUIRE(rv == eswb_e_ok);
 
-        SECTION("Greater than event queue buffer size") {
-            setup_queue_record(&evqr, eqr_topic_proclaim, bulk_data, EVQ_DATA_BUF_SIZE + 1);
-            rv = local_event_queue_update(bh, &evqr);
-            REQUIRE(rv == eswb_e_ev_queue_payload_too_large);
-        }
+        // write loan was committed and the topic is unlocked
+        structure st_rcv;
+        rv = eswb_read(subs_td, &st_rcv);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(st_rcv.a == 3.5);
 
-#       define OVERWRITING_MARGIN 4
-        for (int pushes_num = 8; pushes_num <= EVQ_QUEUE_SIZE + OVERWRITING_MARGIN; pushes_num++) {
-            int pops = 0;
-            SECTION(std::string("Event FIFO overwriting ") + std::to_string(pushes_num) + "/" + std::to_string(EVQ_QUEUE_SIZE)) {
-#           define NON_OVERWRITING_PAYLOAD_SIZE (( EVQ_DATA_BUF_SIZE / EVQ_QUEUE_SIZE ) - 1)
-                setup_queue_record(&evqr, eqr_topic_update, bulk_data, NON_OVERWRITING_PAYLOAD_SIZE);
+        const void *rp;
+        rv = eswb_topic_borrow_read(subs_td, &rp);
+        REQUIRE(rv == eswb_e_ok);
 
-                for (int i = 0; i < pushes_num; i++) { //EVQ_QUEUE_SIZE + OVERWRITING_MARGIN
-                    bulk_data[0] = i; // contains packet counter
-                    rv = local_event_queue_update(bh, &evqr);
-                    REQUIRE(rv == eswb_e_ok);
-                }
+        rv = eswb_disconnect(subs_td);
+        REQUIRE(rv == eswb_e_ok);
 
-                do {
-                    rv = local_fifo_pop(event_queue_td, eqt, 1);
-                    if ((rv == eswb_e_ok) || (rv == eswb_e_fifo_rcvr_underrun)) {
-                        if (pushes_num > EVQ_QUEUE_SIZE) {
-                            CHECK(EVENT_QUEUE_TRANSFER_DATA(eqt)[0] == pops + pushes_num - EVQ_QUEUE_SIZE);
-                        } else {
-                            CHECK(EVENT_QUEUE_TRANSFER_DATA(eqt)[0] == pops);
-                        }
-                        EVENT_QUEUE_TRANSFER_DATA(eqt)[0] = ((uint8_t *) evqr.data)[0] = 0;// resetting expected difference
-                        CHECK(compare_event_queue_transfer(&evqr, eqt) == 0);
-                        pops++;
-                        rv = eswb_e_ok;
-                    }
-                    //REQUIRE(rv == eswb_e_ok);
-                } while (rv != eswb_e_no_update);
-                int expected_pops = pushes_num > EVQ_QUEUE_SIZE ? EVQ_QUEUE_SIZE : pushes_num;
-                CHECK(pops == expected_pops);
-            }
-        }
+        eswb_topic_descr_t td;
+        rv = eswb_connect((bus_path + "/st").c_str(), &td);
+        REQUIRE(rv == eswb_e_ok);
 
-        SECTION("Data buffer overwriting") {
-#           define OVERWRITING_DATA_SIZE sizeof(bulk_data)
-            setup_queue_record(&evqr, eqr_topic_update, bulk_data, OVERWRITING_DATA_SIZE);
+        st.a = 4.5;
+        rv = eswb_update_topic(td, &st);
+        REQUIRE(rv == eswb_e_ok);
 
-            for (int i = 0; i < 6; i++) {
-                bulk_data[0]++;
-                rv = local_event_queue_update(bh, &evqr);
-                REQUIRE(rv == eswb_e_ok);
-            }
+        rv = eswb_topic_loan_write(td, &wp);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_topic_commit(td);
+        REQUIRE(rv == eswb_e_ok);
+    }
 
-            int pops = 0;
-            do {
-                rv = local_fifo_pop(event_queue_td, eqt, 1);
-                if ((rv == eswb_e_ok) || (rv == eswb_e_fifo_rcvr_underrun)) {
-                    EVENT_QUEUE_TRANSFER_DATA(eqt)[0] = ((uint8_t *) evqr.data)[0] = 0;// resetting expected difference
-                    CHECK(compare_event_queue_transfer(&evqr, eqt) == 0);
-                    pops++;
-                    rv = eswb_e_ok;
-                }
-                //REQUIRE(rv == eswb_e_ok);
-            } while (rv != eswb_e_no_update);
+    SECTION("Disconnect after bus is deleted") {
+        void *wp;
+        rv = eswb_topic_loan_write(publish_td, &wp);
+        REQUIRE(rv == eswb_e_ok);
 
-            CHECK(pops == EVQ_DATA_BUF_SIZE / OVERWRITING_DATA_SIZE);
-        }
+        rv = eswb_delete(bus_path.c_str());
+        REQUIRE(rv == eswb_e_ok);
 
-        SECTION("Event queue stream demux") {
-            REQUIRE(1 == eswb_e_ok);
-        }
+        rv = eswb_disconnect(publish_td);
+        CHECK(rv == eswb_e_ok);
     }
 
+    SECTION("FIFO is not loanable") {
+        TOPIC_TREE_CONTEXT_LOCAL_RESET(cntx);
+        topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", 4);
+        usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32, 0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
 
-    if (eqt != NULL) {
-        free(eqt);
+        eswb_topic_descr_t fifo_td;
+        rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, &fifo_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        void *wp;
+        rv = eswb_topic_loan_write(fifo_td, &wp);
+        REQUIRE(rv == eswb_e_not_supported);
     }
 }
 
-#include "eswb/event_queue.h"
-#include "eswb/topic_proclaiming_tree.h"
+TEST_CASE("Topic data loan notifies subscribers") {
+    eswb_rv_t rv;
 
-TEST_CASE("Basic event queue and replication") {
+    eswb_local_init(1);
 
-    // create source bus
-    std::string src_bus_name("src_bus");
-    eswb_rv_t rv = eswb_create(src_bus_name.c_str(), eswb_non_synced, 20);
-    REQUIRE(rv == eswb_e_ok);
+    std::string bus_path = "itb:/bus";
 
-    std::string src_bus_path = "nsb:/" + src_bus_name;
-    eswb_topic_descr_t src_td;
-    rv = eswb_connect(src_bus_path.c_str(), &src_td);
+    rv = eswb_create("bus", eswb_inter_thread, 20);
     REQUIRE(rv == eswb_e_ok);
 
-    // create dst bus
-    std::string dst_bus_name("dst_bus");
-    rv = eswb_create(dst_bus_name.c_str(), eswb_non_synced, 20);
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_plain(bus_path.c_str(), "frame", 1024, &publish_td);
     REQUIRE(rv == eswb_e_ok);
 
-    std::string dst_bus_path = "nsb:/" + dst_bus_name;
-    eswb_topic_descr_t dst_td;
-    rv = eswb_connect(dst_bus_path.c_str(), &dst_td);
+    eswb_topic_descr_t subs_td;
+    rv = eswb_connect((bus_path + "/frame").c_str(), &subs_td);
     REQUIRE(rv == eswb_e_ok);
 
-    // enable event queue
-    rv = eswb_event_queue_enable(src_td, 20, 2000);
-    REQUIRE(rv == eswb_e_ok);
+    std::atomic<bool> got_update(false);
+    uint8_t frame[1024];
 
-    // order topics root
-#   define TELEMETRY_CHANNEL 1
-    rv = eswb_event_queue_order_topic(src_td, src_bus_name.c_str(), TELEMETRY_CHANNEL);
-    REQUIRE(rv == eswb_e_ok);
+    std::thread subscriber([&] () {
+        eswb_arm_timeout(subs_td, 1000000);
+        if (eswb_get_update(subs_td, frame) == eswb_e_ok) {
+            got_update = true;
+        }
+    });
 
-    // connect to event queue
-    eswb_topic_descr_t ev_q_td;
-    rv = eswb_event_queue_subscribe(src_bus_path.c_str(), &ev_q_td);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    void *wp;
+    rv = eswb_topic_loan_write(publish_td, &wp);
+    REQUIRE(rv == eswb_e_ok);
+    memset(wp, 0x5A, 1024);
+    rv = eswb_topic_commit(publish_td);
     REQUIRE(rv == eswb_e_ok);
 
-    // proclaim topic
-    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 10);
-    struct structure {
-        double a;
-        double b;
-        double c;
-    } st = {0};
-    topic_proclaiming_tree_t *rt = usr_topic_set_struct(cntx, st, "st");
-    usr_topic_add_struct_child(cntx, rt, struct structure, a, "a", tt_double);
-    usr_topic_add_struct_child(cntx, rt, struct structure, b, "b", tt_double);
-    usr_topic_add_struct_child(cntx, rt, struct structure, c, "c", tt_double);
+    subscriber.join();
 
-    eswb_topic_descr_t src_struct_td;
-    rv = eswb_proclaim_tree_by_path(src_bus_path.c_str(), rt, cntx->t_num, &src_struct_td);
+    REQUIRE(got_update);
+    CHECK(frame[0] == 0x5A);
+    CHECK(frame[1023] == 0x5A);
+}
+
+TEST_CASE("Broadcast is skipped without blocked subscribers") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    std::string bus_path = "itb:/bus";
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
     REQUIRE(rv == eswb_e_ok);
 
-    // TODO: create a convention for subtopics to inherit subscription mask (e.g. bits 16-32 are inheritable)
-    rv = eswb_event_queue_order_topic(src_td, (src_bus_name + "/st").c_str(), TELEMETRY_CHANNEL);
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_plain(bus_path.c_str(), "cnt", sizeof(uint32_t), &publish_td);
     REQUIRE(rv == eswb_e_ok);
 
+    eswb_topic_descr_t subs_td;
+    rv = eswb_connect((bus_path + "/cnt").c_str(), &subs_td);
+    REQUIRE(rv == eswb_e_ok);
 
-#define A_VAL 1.0
-#define B_VAL 1.33
-#define C_VAL 2.0
-    st.a = A_VAL;
-    st.b = B_VAL;
-    st.c = C_VAL;
+    topic_stats_t stats;
 
-    rv = eswb_update_topic(src_struct_td, &st);
+    for (uint32_t i = 0; i < 100; i++) {
+        rv = eswb_update_topic(publish_td, &i);
+        REQUIRE(rv == eswb_e_ok);
+    }
+
+    rv = eswb_get_topic_stats(subs_td, &stats);
     REQUIRE(rv == eswb_e_ok);
+    CHECK(stats.wakeups == 0);
+    CHECK(stats.wakeups_skipped == 100);
 
-    st.a *= 2;
-    st.b *= 2;
-    st.c *= 2;
+    std::atomic<bool> got_update(false);
 
-    rv = eswb_update_topic(src_struct_td, &st);
+    std::thread subscriber([&] () {
+        uint32_t v;
+        eswb_arm_timeout(subs_td, 1000000);
+        if (eswb_get_update(subs_td, &v) == eswb_e_ok) {
+            got_update = true;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    uint32_t v = 100;
+    rv = eswb_update_topic(publish_td, &v);
     REQUIRE(rv == eswb_e_ok);
 
-    struct structure receiver_st = {0};
+    subscriber.join();
+    REQUIRE(got_update);
 
-    topic_id_map_t *tid_map;
-    rv = map_alloc(&tid_map, 10);
+    rv = eswb_get_topic_stats(subs_td, &stats);
     REQUIRE(rv == eswb_e_ok);
+    CHECK(stats.wakeups == 1);
+    CHECK(stats.wakeups_skipped == 100);
+}
 
-    // pop queue, post to replication
-    uint8_t event_buf [512];
-    event_queue_transfer_t *event = (event_queue_transfer_t*)event_buf;
+TEST_CASE("Wait for any of several topics") {
+    eswb_rv_t rv;
 
-    rv = eswb_event_queue_pop(ev_q_td, event);
+    eswb_local_init(1);
+
+    std::string bus_path = "itb:/bus";
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
     REQUIRE(rv == eswb_e_ok);
-    rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+
+    eswb_topic_descr_t a_td, b_td;
+    rv = eswb_proclaim_plain(bus_path.c_str(), "a", sizeof(uint32_t), &a_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_proclaim_plain(bus_path.c_str(), "b", sizeof(uint32_t), &b_td);
     REQUIRE(rv == eswb_e_ok);
 
-    eswb_topic_descr_t td_a;
-    eswb_topic_descr_t td_b;
-    eswb_topic_descr_t td_c;
-    rv = eswb_connect((dst_bus_path + "/st/a").c_str(), &td_a);
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+    topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", 64);
+    usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32, 0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
+
+    eswb_topic_descr_t fifo_snd_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, &fifo_snd_td);
     REQUIRE(rv == eswb_e_ok);
-    rv = eswb_connect((dst_bus_path + "/st/b").c_str(), &td_b);
+
+    eswb_topic_descr_t tds[3];
+    rv = eswb_connect((bus_path + "/a").c_str(), &tds[0]);
     REQUIRE(rv == eswb_e_ok);
-    rv = eswb_connect((dst_bus_path + "/st/c").c_str(), &td_c);
+    rv = eswb_connect((bus_path + "/b").c_str(), &tds[1]);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_fifo_subscribe((bus_path + "/fifo/elem").c_str(), &tds[2]);
     REQUIRE(rv == eswb_e_ok);
 
+    int ready_mask = -1;
+    uint32_t v = 0;
 
-    rv = eswb_event_queue_pop(ev_q_td, event);
+    SECTION("Timeout") {
+        rv = eswb_wait_any(tds, 3, 10000, &ready_mask);
+        CHECK(rv == eswb_e_timedout);
+        CHECK(ready_mask == 0);
+    }
+
+    SECTION("Update wakes the waiter") {
+        std::thread publisher([&] () {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            uint32_t d = 2;
+            eswb_update_topic(b_td, &d);
+        });
+
+        rv = eswb_wait_any(tds, 3, 1000000, &ready_mask);
+        publisher.join();
+
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(ready_mask == (1 << 1));
+        eswb_read(tds[1], &v);
+        CHECK(v == 2);
+    }
+
+    SECTION("FIFO is ready while it is not empty") {
+        v = 5;
+        rv = eswb_fifo_push(fifo_snd_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_wait_any(tds, 3, 10000, &ready_mask);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(ready_mask == (1 << 2));
+
+        rv = eswb_fifo_pop(tds[2], &v);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(v == 5);
+
+        rv = eswb_wait_any(tds, 3, 10000, &ready_mask);
+        CHECK(rv == eswb_e_timedout);
+    }
+
+    SECTION("Single thread serves several publishers") {
+        const uint32_t updates_num = 1000;
+
+        std::thread publisher_a([&] () {
+            for (uint32_t i = 1; i <= updates_num; i++) {
+                eswb_update_topic(a_td, &i);
+            }
+        });
+        std::thread publisher_fifo([&] () {
+            for (uint32_t i = 1; i <= updates_num; i++) {
+                eswb_fifo_push(fifo_snd_td, &i);
+                if ((i % 4) == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        });
+
+        uint32_t last_a = 0;
+        uint32_t last_fifo = 0;
+        int wakeups = 0;
+        do {
+            // updates between the calls are not tracked for regular topics, so the last one may be missed
+            rv = eswb_wait_any(tds, 3, 10000, &ready_mask);
+            if (rv == eswb_e_timedout) {
+                eswb_read(tds[0], &last_a);
+                continue;
+            }
+            REQUIRE(rv == eswb_e_ok);
+            wakeups++;
+
+            if (ready_mask & (1 << 0)) {
+                eswb_read(tds[0], &last_a);
+            }
+            if (ready_mask & (1 << 2)) {
+                while (eswb_fifo_try_pop(tds[2], &v) == eswb_e_ok) {
+                    CHECK(v == last_fifo + 1);
+                    last_fifo = v;
+                }
+            }
+        } while ((last_a < updates_num) || (last_fifo < updates_num));
+
+        publisher_a.join();
+        publisher_fifo.join();
+
+        CHECK(wakeups > 0);
+    }
+
+    SECTION("Non synced bus is not supported") {
+        rv = eswb_create("nsbus", eswb_non_synced, 20);
+        REQUIRE(rv == eswb_e_ok);
+
+        eswb_topic_descr_t nsb_td;
+        rv = eswb_proclaim_plain("nsb:/nsbus", "c", sizeof(uint32_t), &nsb_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_wait_any(&nsb_td, 1, 10000, &ready_mask);
+        CHECK(rv == eswb_e_not_supported);
+
+        rv = eswb_wait_any(tds, 0, 10000, &ready_mask);
+        CHECK(rv == eswb_e_invargs);
+    }
+}
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+
+static int pollfd_is_signalled(int fd) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    return poll(&pfd, 1, 0) == 1;
+}
+
+static void pollfd_reset(int fd) {
+    uint64_t cnt;
+    while (read(fd, &cnt, sizeof(cnt)) == sizeof(cnt));
+}
+
+TEST_CASE("Topic poll descriptor") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    std::string bus_path = "itb:/bus";
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
     REQUIRE(rv == eswb_e_ok);
-    rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_plain(bus_path.c_str(), "a", sizeof(uint32_t), &publish_td);
     REQUIRE(rv == eswb_e_ok);
 
-    double value;
-    rv = eswb_get_update(td_a, &value);
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+    topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", 8);
+    usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32, 0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
+
+    eswb_topic_descr_t fifo_snd_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, &fifo_snd_td);
     REQUIRE(rv == eswb_e_ok);
-    REQUIRE(value == A_VAL);
-    rv = eswb_get_update(td_b, &value);
+
+    eswb_topic_descr_t subs_td;
+    rv = eswb_connect((bus_path + "/a").c_str(), &subs_td);
     REQUIRE(rv == eswb_e_ok);
-    REQUIRE(value == B_VAL);
-    rv = eswb_get_update(td_c, &value);
+
+    int fd;
+    rv = eswb_topic_get_pollfd(subs_td, &fd);
     REQUIRE(rv == eswb_e_ok);
-    REQUIRE(value == C_VAL);
+    REQUIRE(fd >= 0);
 
-    rv = eswb_event_queue_pop(ev_q_td, event);
+    int fd2;
+    rv = eswb_topic_get_pollfd(subs_td, &fd2);
     REQUIRE(rv == eswb_e_ok);
-    rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+    CHECK(fd == fd2);
+
+    uint32_t v = 1;
+
+    SECTION("Topic update") {
+        CHECK_FALSE(pollfd_is_signalled(fd));
+
+        rv = eswb_update_topic(publish_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(pollfd_is_signalled(fd));
+
+        pollfd_reset(fd);
+        CHECK_FALSE(pollfd_is_signalled(fd));
+    }
+
+    SECTION("FIFO push") {
+        rv = eswb_fifo_push(fifo_snd_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+
+        eswb_topic_descr_t fifo_rcv_td;
+        rv = eswb_fifo_subscribe((bus_path + "/fifo/elem").c_str(), &fifo_rcv_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        int fifo_fd;
+        rv = eswb_topic_get_pollfd(fifo_rcv_td, &fifo_fd);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK_FALSE(pollfd_is_signalled(fifo_fd));
+
+        rv = eswb_fifo_push(fifo_snd_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(pollfd_is_signalled(fifo_fd));
+        CHECK_FALSE(pollfd_is_signalled(fd));
+
+        pollfd_reset(fifo_fd);
+        rv = eswb_fifo_pop(fifo_rcv_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+    }
+
+    SECTION("Pending FIFO signals right away") {
+        eswb_topic_descr_t fifo_rcv_td;
+        rv = eswb_fifo_subscribe((bus_path + "/fifo/elem").c_str(), &fifo_rcv_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_fifo_push(fifo_snd_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+
+        int fifo_fd;
+        rv = eswb_topic_get_pollfd(fifo_rcv_td, &fifo_fd);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(pollfd_is_signalled(fifo_fd));
+    }
+
+    SECTION("Non synced bus") {
+        rv = eswb_create("nsbus", eswb_non_synced, 20);
+        REQUIRE(rv == eswb_e_ok);
+
+        eswb_topic_descr_t nsb_td;
+        rv = eswb_proclaim_plain("nsb:/nsbus", "c", sizeof(uint32_t), &nsb_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_topic_get_pollfd(nsb_td, &fd2);
+        CHECK(rv == eswb_e_not_supported);
+    }
+}
+#endif
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+TEST_CASE("Interprocess bus") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    // forked before the bus exists, so the child attaches the segment like an unrelated process
+    int go_pipe[2];
+    REQUIRE(pipe(go_pipe) == 0);
+
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+
+    if (pid == 0) {
+        char c;
+        close(go_pipe[1]);
+        if (read(go_pipe[0], &c, 1) != 1) {
+            _exit(1);
+        }
+        if (c == 0) {
+            _exit(0);
+        }
+
+        eswb_topic_descr_t td;
+        if (eswb_connect("ipb:/ipbus/a", &td) != eswb_e_ok) {
+            _exit(2);
+        }
+
+        uint32_t v = 0;
+        if (eswb_read(td, &v) != eswb_e_ok || v != 1) {
+            _exit(3);
+        }
+
+        v = 42;
+        for (int i = 0; i < 50; i++) {
+            if (eswb_update_topic(td, &v) != eswb_e_ok) {
+                _exit(4);
+            }
+            usleep(10000);
+        }
+        _exit(0);
+    }
+
+    close(go_pipe[0]);
+
+    rv = eswb_create("ipbus", eswb_inter_process, 20);
     REQUIRE(rv == eswb_e_ok);
 
-    rv = eswb_get_update(td_a, &value);
+    eswb_topic_descr_t publish_td;
+    rv = eswb_proclaim_plain("ipb:/ipbus", "a", sizeof(uint32_t), &publish_td);
     REQUIRE(rv == eswb_e_ok);
-    REQUIRE(value == A_VAL * 2);
-    rv = eswb_get_update(td_b, &value);
+
+    uint32_t v = 1;
+    rv = eswb_update_topic(publish_td, &v);
     REQUIRE(rv == eswb_e_ok);
-    REQUIRE(value == B_VAL * 2);
-    rv = eswb_get_update(td_c, &value);
+
+    SECTION("Bus exists") {
+        rv = eswb_create("ipbus", eswb_inter_process, 20);
+        CHECK(rv == eswb_e_bus_exists);
+
+        eswb_topic_descr_t td;
+        rv = eswb_connect("ipbus/a", &td);
+        CHECK(rv == eswb_e_ok);
+
+        int ready_mask;
+        rv = eswb_wait_any(&td, 1, 1000, &ready_mask);
+        CHECK(rv == eswb_e_not_supported);
+
+        char c = 0;
+        REQUIRE(write(go_pipe[1], &c, 1) == 1);
+    }
+
+    SECTION("Update from another process") {
+        eswb_topic_descr_t subs_td;
+        rv = eswb_connect("ipb:/ipbus/a", &subs_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_arm_timeout(subs_td, 100000);
+        REQUIRE(rv == eswb_e_ok);
+
+        char c = 1;
+        REQUIRE(write(go_pipe[1], &c, 1) == 1);
+
+        uint32_t rcv = 0;
+        for (int i = 0; (i < 20) && (rcv != 42); i++) {
+            rv = eswb_get_update(subs_td, &rcv);
+            REQUIRE(((rv == eswb_e_ok) || (rv == eswb_e_timedout)));
+        }
+        CHECK(rcv == 42);
+    }
+
+    close(go_pipe[1]);
+
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+
+    rv = eswb_delete("ipb:/ipbus");
+    CHECK(rv == eswb_e_ok);
+}
+
+#ifdef __linux__
+#define IPB_EXEC_BUS_ENV "ESWB_TEST_IPB_EXEC_BUS"
+
+// runs in a process exec'd by "Interprocess bus attach from exec'd process"
+TEST_CASE("Interprocess bus exec'd attacher", "[.]") {
+    const char *bus = getenv(IPB_EXEC_BUS_ENV);
+    if (bus == NULL) {
+        return;
+    }
+
+    std::string path = std::string("ipb:/") + bus + "/a";
+    eswb_topic_descr_t td;
+    REQUIRE(eswb_connect(path.c_str(), &td) == eswb_e_ok);
+
+    uint32_t v = 0;
+    REQUIRE(eswb_read(td, &v) == eswb_e_ok);
+    CHECK(v == 1);
+
+    v = 43;
+    REQUIRE(eswb_update_topic(td, &v) == eswb_e_ok);
+}
+
+TEST_CASE("Interprocess bus attach from exec'd process") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("ipbexec", eswb_inter_process, 20);
     REQUIRE(rv == eswb_e_ok);
-    REQUIRE(value == C_VAL * 2);
 
-    // compare topics values
-    // reset busses context
+    eswb_topic_descr_t td;
+    rv = eswb_proclaim_plain("ipb:/ipbexec", "a", sizeof(uint32_t), &td);
+    REQUIRE(rv == eswb_e_ok);
+
+    uint32_t v = 1;
+    rv = eswb_update_topic(td, &v);
+    REQUIRE(rv == eswb_e_ok);
+
+    // unlike a forked child, exec'd process has its own address space layout
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+
+    if (pid == 0) {
+        setenv(IPB_EXEC_BUS_ENV, "ipbexec", 1);
+        execl("/proc/self/exe", "eswb_test", "Interprocess bus exec'd attacher", (char *) NULL);
+        _exit(127);
+    }
+
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+
+    rv = eswb_read(td, &v);
+    REQUIRE(rv == eswb_e_ok);
+    CHECK(v == 43);
+
+    rv = eswb_delete("ipb:/ipbexec");
+    CHECK(rv == eswb_e_ok);
+}
+#endif
+
+TEST_CASE("Topic path") {
+    eswb_rv_t rv;
+
     eswb_local_init(1);
+
+    eswb_type_t bus_type = GENERATE(eswb_inter_thread, eswb_non_synced, eswb_inter_process);
+    std::string bus_path = std::string(eswb_get_bus_prefix(bus_type)) + "pbus";
+
+    rv = eswb_create("pbus", bus_type, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t td;
+    rv = eswb_proclaim_plain(bus_path.c_str(), "a", sizeof(uint32_t), &td);
+    REQUIRE(rv == eswb_e_ok);
+
+    char path[ESWB_TOPIC_MAX_PATH_LEN + 1];
+    rv = eswb_get_topic_path(td, path);
+    REQUIRE(rv == eswb_e_ok);
+    CHECK(std::string(path) == bus_path + "/a");
+
+    eswb_topic_descr_t root_td;
+    rv = eswb_connect(bus_path.c_str(), &root_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t nested_td;
+    rv = eswb_connect_nested(root_td, "a", &nested_td);
+    CHECK(rv == eswb_e_ok);
+
+    rv = eswb_delete_by_td(root_td);
+    CHECK(rv == eswb_e_ok);
+}
+
+TEST_CASE("Lock-free FIFO", "[unit]") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    std::string bus_path = "itb:/bus";
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+#   define LF_FIFO_SIZE 64
+    topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", LF_FIFO_SIZE);
+    fifo_root->flags |= TOPIC_FLAG_LOCKFREE_FIFO;
+    usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32, 0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
+
+    eswb_topic_descr_t snd_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, &snd_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    SECTION("Try pop and underrun") {
+        eswb_topic_descr_t rcv_td;
+        rv = eswb_fifo_subscribe((bus_path + "/fifo/elem").c_str(), &rcv_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        uint32_t v;
+        rv = eswb_fifo_try_pop(rcv_td, &v);
+        REQUIRE(rv == eswb_e_no_update);
+
+        for (uint32_t i = 0; i < LF_FIFO_SIZE + 4; i++) {
+            rv = eswb_fifo_push(snd_td, &i);
+            REQUIRE(rv == eswb_e_ok);
+        }
+
+        // lock-free reader skips the oldest element, as it is the next to be overwritten
+        rv = eswb_fifo_try_pop(rcv_td, &v);
+        REQUIRE(rv == eswb_e_fifo_rcvr_underrun);
+        REQUIRE(v == 5);
+
+        for (uint32_t i = 6; i < LF_FIFO_SIZE + 4; i++) {
+            rv = eswb_fifo_try_pop(rcv_td, &v);
+            REQUIRE(rv == eswb_e_ok);
+            REQUIRE(v == i);
+        }
+
+        rv = eswb_fifo_try_pop(rcv_td, &v);
+        REQUIRE(rv == eswb_e_no_update);
+    }
+
+    SECTION("Timed out pop") {
+        eswb_topic_descr_t rcv_td;
+        rv = eswb_fifo_subscribe((bus_path + "/fifo/elem").c_str(), &rcv_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_arm_timeout(rcv_td, 10000);
+        REQUIRE(rv == eswb_e_ok);
+        uint32_t v;
+        rv = eswb_fifo_pop(rcv_td, &v);
+        REQUIRE(rv == eswb_e_timedout);
+    }
+
+    SECTION("Single producer, multiple blocked consumers") {
+#       define LF_CONSUMERS 3
+#       define LF_ELEMS 200000
+        std::atomic<int> failures(0);
+        std::atomic<int> ready(0);
+        std::vector<std::thread> consumers;
+
+        for (int c = 0; c < LF_CONSUMERS; c++) {
+            consumers.emplace_back([&] () {
+                eswb_topic_descr_t rcv_td;
+                if (eswb_fifo_subscribe((bus_path + "/fifo/elem").c_str(), &rcv_td) != eswb_e_ok) {
+                    failures++;
+                    return;
+                }
+                ready++;
+
+                uint32_t prev = 0;
+                uint32_t v;
+                do {
+                    eswb_rv_t erv = eswb_fifo_pop(rcv_td, &v);
+                    if (erv == eswb_e_ok) {
+                        if (prev != 0 && v != prev + 1) failures++;
+                    } else if (erv == eswb_e_fifo_rcvr_underrun) {
+                        if (v <= prev) failures++;
+                    } else {
+                        failures++;
+                        break;
+                    }
+                    prev = v;
+                } while (v != LF_ELEMS);
+            });
+        }
+
+        while (ready < LF_CONSUMERS) {
+            std::this_thread::yield();
+        }
+
+        for (uint32_t i = 1; i <= LF_ELEMS; i++) {
+            rv = eswb_fifo_push(snd_td, &i);
+            REQUIRE(rv == eswb_e_ok);
+        }
+
+        for (auto &c: consumers) {
+            c.join();
+        }
+
+        REQUIRE(failures == 0);
+    }
+}
+
+TEST_CASE("FIFO batch push and pop", "[unit]") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    eswb_type_t bus_type = GENERATE(eswb_inter_thread, eswb_non_synced);
+    uint32_t flags = GENERATE(0, TOPIC_FLAG_LOCKFREE_FIFO);
+    std::string bus_path = std::string(eswb_get_bus_prefix(bus_type)) + "bus";
+
+    rv = eswb_create("bus", bus_type, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+#   define BATCH_FIFO_SIZE 16
+    struct elem {
+        uint32_t v;
+        uint8_t tag; // makes element step differ from element size
+    } __attribute__((packed));
+    topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", BATCH_FIFO_SIZE);
+    fifo_root->flags |= flags;
+    usr_topic_add_child(cntx, fifo_root, "elem", tt_plain_data, 0, sizeof(elem), TOPIC_FLAG_MAPPED_TO_PARENT);
+
+    eswb_topic_descr_t snd_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, &snd_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t rcv_td;
+    rv = eswb_fifo_subscribe((bus_path + "/fifo/elem").c_str(), &rcv_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    elem snd[BATCH_FIFO_SIZE * 2];
+    elem rcv[BATCH_FIFO_SIZE * 2];
+    for (uint32_t i = 0; i < BATCH_FIFO_SIZE * 2; i++) {
+        snd[i].v = i;
+        snd[i].tag = i & 0xFF;
+    }
+
+    eswb_size_t got;
+
+    SECTION("Batches wrapping around") {
+        for (int round = 0; round < 10; round++) {
+            elem *batch = &snd[(round * 7) % BATCH_FIFO_SIZE];
+            rv = eswb_fifo_push_n(snd_td, batch, 7);
+            REQUIRE(rv == eswb_e_ok);
+
+            rv = eswb_fifo_pop_n(rcv_td, rcv, BATCH_FIFO_SIZE, &got);
+            REQUIRE(rv == eswb_e_ok);
+            REQUIRE(got == 7);
+            for (eswb_size_t i = 0; i < got; i++) {
+                REQUIRE(rcv[i].v == batch[i].v);
+                REQUIRE(rcv[i].tag == batch[i].tag);
+            }
+        }
+    }
+
+    SECTION("Pop is limited by max") {
+        rv = eswb_fifo_push_n(snd_td, snd, 10);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_fifo_pop_n(rcv_td, rcv, 4, &got);
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(got == 4);
+        REQUIRE(rcv[3].v == 3);
+
+        elem e;
+        rv = eswb_fifo_pop(rcv_td, &e);
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(e.v == 4);
+
+        rv = eswb_fifo_pop_n(rcv_td, rcv, BATCH_FIFO_SIZE, &got);
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(got == 5);
+        REQUIRE(rcv[4].v == 9);
+    }
+
+    SECTION("Single pushes are popped in batch") {
+        for (int i = 0; i < 5; i++) {
+            rv = eswb_fifo_push(snd_td, &snd[i]);
+            REQUIRE(rv == eswb_e_ok);
+        }
+        rv = eswb_fifo_pop_n(rcv_td, rcv, BATCH_FIFO_SIZE, &got);
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(got == 5);
+        for (eswb_size_t i = 0; i < got; i++) {
+            REQUIRE(rcv[i].v == i);
+            REQUIRE(rcv[i].tag == i);
+        }
+    }
+
+    SECTION("Batch larger than fifo causes underrun") {
+        rv = eswb_fifo_push_n(snd_td, snd, BATCH_FIFO_SIZE * 2);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_fifo_pop_n(rcv_td, rcv, BATCH_FIFO_SIZE * 2, &got);
+        REQUIRE(rv == eswb_e_fifo_rcvr_underrun);
+        REQUIRE(got > 0);
+        REQUIRE(got <= BATCH_FIFO_SIZE);
+        REQUIRE(rcv[got - 1].v == BATCH_FIFO_SIZE * 2 - 1);
+        for (eswb_size_t i = 1; i < got; i++) {
+            REQUIRE(rcv[i].v == rcv[i - 1].v + 1);
+        }
+    }
+
+    SECTION("Zero sized batch") {
+        rv = eswb_fifo_push_n(snd_td, snd, 0);
+        REQUIRE(rv == eswb_e_invargs);
+    }
+}
+
+TEST_CASE("FIFO | nsb", "[unit]") {
+
+    eswb_local_init(1);
+
+    std::string bus_name("bus");
+    std::string bus_path = "nsb:/" + bus_name;
+
+    eswb_rv_t rv = eswb_create(bus_name.c_str(), eswb_non_synced, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 10);
+#   define FIFO_SIZE 10
+    topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", FIFO_SIZE);
+    usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32,
+                                                              0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
+
+    eswb_topic_descr_t snd_td;
+    rv = eswb_proclaim_tree_by_path(bus_path.c_str(), fifo_root, cntx->t_num, &snd_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t rcv_td;
+    rv = eswb_fifo_subscribe( (bus_path + "/fifo/elem").c_str(), &rcv_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    SECTION("Single push and pop") {
+        uint32_t data_snd = 123;
+        uint32_t data_rcv;
+        rv = eswb_fifo_push(snd_td, &data_snd);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = eswb_fifo_pop(rcv_td, &data_rcv);
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(data_snd == data_rcv);
+    }
+
+    SECTION(std::string("push and pop N times; fifo size = ") + std::to_string(FIFO_SIZE) ) {
+        for (int intrctn_num = 6; intrctn_num < FIFO_SIZE * 2 + 4; intrctn_num += intrctn_num < FIFO_SIZE + 1 ? 1 : 2 ) {
+            SECTION(std::string("Push and pop ") + std::to_string(intrctn_num)) {
+                for (int i = 0; i < intrctn_num; i++) {
+                    uint32_t data_snd = intrctn_num + i;
+                    uint32_t data_rcv;
+                    rv = eswb_fifo_push(snd_td, &data_snd);
+                    REQUIRE(rv == eswb_e_ok);
+
+                    rv = eswb_fifo_pop(rcv_td, &data_rcv);
+                    REQUIRE(rv == eswb_e_ok);
+                    REQUIRE(data_snd == data_rcv);
+                }
+            }
+        }
+    }
+
+    SECTION("Underrun detection") {
+
+#       define OVERRUN_MARGIN 4
+        for (int i = 0; i < FIFO_SIZE + OVERRUN_MARGIN; i++) {
+            uint32_t data_snd = i;
+            rv = eswb_fifo_push(snd_td, &data_snd);
+            REQUIRE(rv == eswb_e_ok);
+        }
+
+        uint32_t data_rcv;
+        rv = eswb_fifo_pop(rcv_td, &data_rcv);
+        CHECK(rv == eswb_e_fifo_rcvr_underrun);
+        CHECK(data_rcv == OVERRUN_MARGIN);
+        rv = eswb_fifo_pop(rcv_td, &data_rcv);
+        CHECK(rv == eswb_e_ok);
+        CHECK(data_rcv == OVERRUN_MARGIN + 1);
+    }
+
+    SECTION("Push N times, Pop M; N > M") {
+
+        for (int pushes = 11; pushes < FIFO_SIZE * 2 + 4; pushes += pushes < FIFO_SIZE + 4 ? 1 : 2) {
+            SECTION(std::string("Push and pop ") + std::to_string(pushes)) {
+                for (int i = 0; i < pushes; i++) {
+                    uint32_t data_snd = i;
+                    rv = eswb_fifo_push(snd_td, &data_snd);
+                    REQUIRE(rv == eswb_e_ok);
+                }
+
+                int pops = 0;
+                int underruns = 0;
+
+                do {
+                    uint32_t data_rcv;
+                    rv = eswb_fifo_pop(rcv_td, &data_rcv);
+                    switch (rv) {
+                        case eswb_e_fifo_rcvr_underrun:
+                            underruns++;
+
+                        case eswb_e_ok:
+                            CHECK(data_rcv == pops + pushes - FIFO_SIZE);
+                            pops++;
+                            break;
+
+                        case eswb_e_no_update:
+                            break;
+
+                        default:
+                            FAIL(rv);
+                            break;
+                    }
+
+                    REQUIRE(pops <= FIFO_SIZE);
+                    REQUIRE(underruns <= 1);
+                } while (rv != eswb_e_no_update);
+                CHECK(pops == FIFO_SIZE);
+            }
+        }
+    }
+
+    SECTION("Fifo state's lap counter overflow") {
+#define INITIAL_LAG 4
+
+        int j;
+        for (int i = 0; i < INITIAL_LAG; i++) {
+            uint32_t data_snd = j++;
+            rv = eswb_fifo_push(snd_td, &data_snd);
+            REQUIRE(rv == eswb_e_ok);
+        }
+
+        for (int k = 0; k < ESWB_FIFO_INDEX_OVERFLOW * 1.5; k++) {
+            for (int i = 0; i < FIFO_SIZE; i++) {
+                uint32_t data_snd = j++;
+                rv = eswb_fifo_push(snd_td, &data_snd);
+                REQUIRE(rv == eswb_e_ok);
+
+                uint32_t data_rcv;
+                rv = eswb_fifo_pop(rcv_td, &data_rcv);
+                REQUIRE(rv == eswb_e_ok);
+                REQUIRE(data_rcv == data_snd - INITIAL_LAG);
+            }
+        }
+    }
+
+    SECTION("FIFO flush" ) {
+        int num_op_pushs = GENERATE(1, 4, 8, 12);
+
+        SECTION(std::to_string(num_op_pushs) + std::string(" pushes")) {
+            for (int push = 0; push < num_op_pushs; push++) {
+                uint32_t data_snd = push;
+                uint32_t data_rcv;
+                rv = eswb_fifo_push(snd_td, &data_snd);
+                REQUIRE(rv == eswb_e_ok);
+
+                rv = eswb_fifo_flush(rcv_td);
+                REQUIRE(rv == eswb_e_ok);
+
+                rv = eswb_fifo_pop(rcv_td, &data_rcv);
+                REQUIRE(rv == eswb_e_no_update);
+
+                // push one more time  and check that it is still working
+                rv = eswb_fifo_push(snd_td, &data_snd);
+                REQUIRE(rv == eswb_e_ok);
+
+                rv = eswb_fifo_pop(rcv_td, &data_rcv);
+                REQUIRE(rv == eswb_e_ok);
+                REQUIRE(data_rcv == data_snd);
+            }
+        }
+    }
+}
+
+
+#include "topic_mem.h"
+#include "registry.h"
+#include "local_buses.h"
+
+extern "C" eswb_rv_t local_bus_create(const char *bus_name, local_bus_type_t type, eswb_size_t max_topics);
+extern "C" eswb_rv_t local_event_queue_update(eswb_bus_handle_t *bh, event_queue_record_t *record);
+
+void setup_queue_record(event_queue_record_t *r, event_queue_record_type_t t, void *d, ssize_t s) {
+    r->size = s;
+    r->topic_id = 777;
+    r->ch_mask = 0xFFFFFFFF;
+    r->type = t;
+    r->origin_seq = 0;
+    r->data = d;
+}
+
+int compare_event_queue_transfer(event_queue_record_t *evqr, event_queue_transfer_t *evqt) {
+
+    if (evqt->type == evqr->type) {
+        if (evqt->topic_id == evqr->topic_id) {
+            if (evqt->size == evqr->size) {
+                int rv = memcmp(evqr->data, EVENT_QUEUE_TRANSFER_DATA(evqt), evqt->size);
+                if (rv != 0) {
+                    uint8_t bufR[200];
+                    uint8_t bufT[200];
+                    for(int i = 0; i < evqt->size; i++) {
+                        bufR[i] = ((uint8_t*)evqr->data)[i];
+                        bufT[i] = EVENT_QUEUE_TRANSFER_DATA(evqt)[i];
+                    }
+                    return rv;
+                }
+                return 0;
+            }
+        }
+    }
+
+    return -1;
+}
+
+TEST_CASE("Event queue io | local bus level", "[unit]") {
+#   define EVQ_TEST_BUS_NAME "evqtb"
+#   define EVQ_TEST_BUS_MAX_TOPICS 10
+#   define EVQ_QUEUE_SIZE 10
+#   define EVQ_DATA_BUF_SIZE 1000
+
+    eswb_rv_t rv;
+    event_queue_transfer_t *eqt = NULL;
+
+    eswb_local_init(1);
+
+    eqt = (event_queue_transfer_t *) calloc(1, EVQ_DATA_BUF_SIZE + sizeof(event_queue_transfer_t));
+
+    rv = local_bus_create(EVQ_TEST_BUS_NAME, local_bus_t_nonsynced, EVQ_TEST_BUS_MAX_TOPICS);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_bus_handle_t *bh;
+    rv = local_lookup_nsb(EVQ_TEST_BUS_NAME, &bh);
+    REQUIRE(rv == eswb_e_ok);
+
+    rv = local_bus_create_event_queue(bh, EVQ_QUEUE_SIZE, EVQ_DATA_BUF_SIZE, 0, 0);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t event_queue_td;
+    std::string evq_path = std::string(EVQ_TEST_BUS_NAME) + std::string("/") + std::string(BUS_EVENT_QUEUE_NAME) + std::string("/event"); // DRY is CRYing
+    rv = local_bus_connect(bh, evq_path.c_str(), &event_queue_td);
+    REQUIRE(rv == eswb_e_ok);
+
+
+    char bulk_data[255];
+    for (int i = 0; i < sizeof(bulk_data); i++) {
+        bulk_data[i] = i;
+    }
+
+    event_queue_record_t evqr;
+
+
+    SECTION("Pushing and checking events") {
+
+        SECTION("Single usual") {
+            double test_val = 123.0;
+            setup_queue_record(&evqr, eqr_topic_update, &test_val, sizeof(test_val));
+
+            rv = local_event_queue_update(bh, &evqr);
+            REQUIRE(rv == eswb_e_ok);
+            rv = local_fifo_pop(event_queue_td, eqt, 1);
+            REQUIRE(rv == eswb_e_ok);
+
+            REQUIRE(compare_event_queue_transfer(&evqr, eqt) == 0);
+        }
+
+        SECTION("Single bulk") {
+            setup_queue_record(&evqr, eqr_topic_proclaim, bulk_data, sizeof(bulk_data));
+
+            rv = local_event_queue_update(bh, &evqr);
+            REQUIRE(rv == eswb_e_ok);
+            rv = local_fifo_pop(event_queue_td, eqt, 1);
+            REQUIRE(rv == eswb_e_ok);
+
+            REQUIRE(compare_event_queue_transfer(&evqr, eqt) == 0);
+        }
+
+        SECTION("Greater than event queue buffer size") {
+            setup_queue_record(&evqr, eqr_topic_proclaim, bulk_data, EVQ_DATA_BUF_SIZE + 1);
+            rv = local_event_queue_update(bh, &evqr);
+            REQUIRE(rv == eswb_e_ev_queue_payload_too_large);
+        }
+
+#       define OVERWRITING_MARGIN 4
+        for (int pushes_num = 8; pushes_num <= EVQ_QUEUE_SIZE + OVERWRITING_MARGIN; pushes_num++) {
+            int pops = 0;
+            SECTION(std::string("Event FIFO overwriting ") + std::to_string(pushes_num) + "/" + std::to_string(EVQ_QUEUE_SIZE)) {
+#           define NON_OVERWRITING_PAYLOAD_SIZE (( EVQ_DATA_BUF_SIZE / EVQ_QUEUE_SIZE ) - 1)
+                setup_queue_record(&evqr, eqr_topic_update, bulk_data, NON_OVERWRITING_PAYLOAD_SIZE);
+
+                for (int i = 0; i < pushes_num; i++) { //EVQ_QUEUE_SIZE + OVERWRITING_MARGIN
+                    bulk_data[0] = i; // contains packet counter
+                    rv = local_event_queue_update(bh, &evqr);
+                    REQUIRE(rv == eswb_e_ok);
+                }
+
+                do {
+                    rv = local_fifo_pop(event_queue_td, eqt, 1);
+                    if ((rv == eswb_e_ok) || (rv == eswb_e_fifo_rcvr_underrun)) {
+                        if (pushes_num > EVQ_QUEUE_SIZE) {
+                            CHECK(EVENT_QUEUE_TRANSFER_DATA(eqt)[0] == pops + pushes_num - EVQ_QUEUE_SIZE);
+                        } else {
+                            CHECK(EVENT_QUEUE_TRANSFER_DATA(eqt)[0] == pops);
+                        }
+                        EVENT_QUEUE_TRANSFER_DATA(eqt)[0] = ((uint8_t *) evqr.data)[0] = 0;// resetting expected difference
+                        CHECK(compare_event_queue_transfer(&evqr, eqt) == 0);
+                        pops++;
+                        rv = eswb_e_ok;
+                    }
+                    //REQUIRE(rv == eswb_e_ok);
+                } while (rv != eswb_e_no_update);
+                int expected_pops = pushes_num > EVQ_QUEUE_SIZE ? EVQ_QUEUE_SIZE : pushes_num;
+                CHECK(pops == expected_pops);
+            }
+        }
+
+        SECTION("Data buffer overwriting") {
+#           define OVERWRITING_DATA_SIZE sizeof(bulk_data)
+            setup_queue_record(&evqr, eqr_topic_update, bulk_data, OVERWRITING_DATA_SIZE);
+
+            for (int i = 0; i < 6; i++) {
+                bulk_data[0]++;
+                rv = local_event_queue_update(bh, &evqr);
+                REQUIRE(rv == eswb_e_ok);
+            }
+
+            int pops = 0;
+            do {
+                rv = local_fifo_pop(event_queue_td, eqt, 1);
+                if ((rv == eswb_e_ok) || (rv == eswb_e_fifo_rcvr_underrun)) {
+                    EVENT_QUEUE_TRANSFER_DATA(eqt)[0] = ((uint8_t *) evqr.data)[0] = 0;// resetting expected difference
+                    CHECK(compare_event_queue_transfer(&evqr, eqt) == 0);
+                    pops++;
+                    rv = eswb_e_ok;
+                }
+                //REQUIRE(rv == eswb_e_ok);
+            } while (rv != eswb_e_no_update);
+
+            CHECK(pops == EVQ_DATA_BUF_SIZE / OVERWRITING_DATA_SIZE);
+        }
+
+        SECTION("Event queue stream demux") {
+            REQUIRE(1 == eswb_e_ok);
+        }
+    }
+
+
+    if (eqt != NULL) {
+        free(eqt);
+    }
+}
+
+#include "eswb/event_queue.h"
+#include "eswb/topic_proclaiming_tree.h"
+
+TEST_CASE("Basic event queue and replication") {
+
+    // create source bus
+    std::string src_bus_name("src_bus");
+    eswb_rv_t rv = eswb_create(src_bus_name.c_str(), eswb_non_synced, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    std::string src_bus_path = "nsb:/" + src_bus_name;
+    eswb_topic_descr_t src_td;
+    rv = eswb_connect(src_bus_path.c_str(), &src_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    // create dst bus
+    std::string dst_bus_name("dst_bus");
+    rv = eswb_create(dst_bus_name.c_str(), eswb_non_synced, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    std::string dst_bus_path = "nsb:/" + dst_bus_name;
+    eswb_topic_descr_t dst_td;
+    rv = eswb_connect(dst_bus_path.c_str(), &dst_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    // enable event queue
+    rv = eswb_event_queue_enable(src_td, 20, 2000);
+    REQUIRE(rv == eswb_e_ok);
+
+    // order topics root
+#   define TELEMETRY_CHANNEL 1
+    rv = eswb_event_queue_order_topic(src_td, src_bus_name.c_str(), TELEMETRY_CHANNEL);
+    REQUIRE(rv == eswb_e_ok);
+
+    // connect to event queue
+    eswb_topic_descr_t ev_q_td;
+    rv = eswb_event_queue_subscribe(src_bus_path.c_str(), &ev_q_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    // proclaim topic
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 10);
+    struct structure {
+        double a;
+        double b;
+        double c;
+    } st = {0};
+    topic_proclaiming_tree_t *rt = usr_topic_set_struct(cntx, st, "st");
+    usr_topic_add_struct_child(cntx, rt, struct structure, a, "a", tt_double);
+    usr_topic_add_struct_child(cntx, rt, struct structure, b, "b", tt_double);
+    usr_topic_add_struct_child(cntx, rt, struct structure, c, "c", tt_double);
+
+    eswb_topic_descr_t src_struct_td;
+    rv = eswb_proclaim_tree_by_path(src_bus_path.c_str(), rt, cntx->t_num, &src_struct_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    // TODO: create a convention for subtopics to inherit subscription mask (e.g. bits 16-32 are inheritable)
+    rv = eswb_event_queue_order_topic(src_td, (src_bus_name + "/st").c_str(), TELEMETRY_CHANNEL);
+    REQUIRE(rv == eswb_e_ok);
+
+
+#define A_VAL 1.0
+#define B_VAL 1.33
+#define C_VAL 2.0
+    st.a = A_VAL;
+    st.b = B_VAL;
+    st.c = C_VAL;
+
+    rv = eswb_update_topic(src_struct_td, &st);
+    REQUIRE(rv == eswb_e_ok);
+
+    st.a *= 2;
+    st.b *= 2;
+    st.c *= 2;
+
+    rv = eswb_update_topic(src_struct_td, &st);
+    REQUIRE(rv == eswb_e_ok);
+
+    struct structure receiver_st = {0};
+
+    topic_id_map_t *tid_map;
+    rv = map_alloc(&tid_map, 10);
+    REQUIRE(rv == eswb_e_ok);
+
+    // pop queue, post to replication
+    uint8_t event_buf [512];
+    event_queue_transfer_t *event = (event_queue_transfer_t*)event_buf;
+
+    rv = eswb_event_queue_pop(ev_q_td, event);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t td_a;
+    eswb_topic_descr_t td_b;
+    eswb_topic_descr_t td_c;
+    rv = eswb_connect((dst_bus_path + "/st/a").c_str(), &td_a);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_connect((dst_bus_path + "/st/b").c_str(), &td_b);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_connect((dst_bus_path + "/st/c").c_str(), &td_c);
+    REQUIRE(rv == eswb_e_ok);
+
+
+    rv = eswb_event_queue_pop(ev_q_td, event);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+    REQUIRE(rv == eswb_e_ok);
+
+    double value;
+    rv = eswb_get_update(td_a, &value);
+    REQUIRE(rv == eswb_e_ok);
+    REQUIRE(value == A_VAL);
+    rv = eswb_get_update(td_b, &value);
+    REQUIRE(rv == eswb_e_ok);
+    REQUIRE(value == B_VAL);
+    rv = eswb_get_update(td_c, &value);
+    REQUIRE(rv == eswb_e_ok);
+    REQUIRE(value == C_VAL);
+
+    rv = eswb_event_queue_pop(ev_q_td, event);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+    REQUIRE(rv == eswb_e_ok);
+
+    rv = eswb_get_update(td_a, &value);
+    REQUIRE(rv == eswb_e_ok);
+    REQUIRE(value == A_VAL * 2);
+    rv = eswb_get_update(td_b, &value);
+    REQUIRE(rv == eswb_e_ok);
+    REQUIRE(value == B_VAL * 2);
+    rv = eswb_get_update(td_c, &value);
+    REQUIRE(rv == eswb_e_ok);
+    REQUIRE(value == C_VAL * 2);
+
+    // compare topics values
+    // reset busses context
+    eswb_local_init(1);
+}
+
+TEST_CASE("Event queue drops events with overwritten data") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t root_td;
+    rv = eswb_connect("itb:/bus", &root_td);
+    REQUIRE(rv == eswb_e_ok);
+
+#   define EVQ_OVR_BUF_SIZE 100
+#   define EVQ_OVR_DATA_SIZE 30
+    rv = eswb_event_queue_enable(root_td, 16, EVQ_OVR_BUF_SIZE);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_order_topic(root_td, "bus", 1);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t ev_q_td;
+    rv = eswb_event_queue_subscribe("itb:/bus", &ev_q_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_set_receive_mask(ev_q_td, 1 << 1);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t td;
+    rv = eswb_proclaim_plain("itb:/bus", "t", EVQ_OVR_DATA_SIZE, &td);
+    REQUIRE(rv == eswb_e_ok);
+
+    uint8_t data[EVQ_OVR_DATA_SIZE];
+    for (int i = 1; i <= 10; i++) {
+        memset(data, i, sizeof(data));
+        rv = eswb_update_topic(td, data);
+        REQUIRE(rv == eswb_e_ok);
+    }
+
+    uint8_t event_buf[sizeof(event_queue_transfer_t) + EVQ_OVR_BUF_SIZE];
+    event_queue_transfer_t *event = (event_queue_transfer_t *) event_buf;
+
+    std::vector<int> popped;
+    while (true) {
+        eswb_arm_timeout(ev_q_td, 10000);
+        rv = eswb_event_queue_pop(ev_q_td, event);
+        if (rv != eswb_e_ok) {
+            break;
+        }
+        REQUIRE(event->type == eqr_topic_update);
+        REQUIRE(event->size == EVQ_OVR_DATA_SIZE);
+
+        uint8_t *d = EVENT_QUEUE_TRANSFER_DATA(event);
+        for (int i = 1; i < EVQ_OVR_DATA_SIZE; i++) {
+            REQUIRE(d[i] == d[0]);
+        }
+        popped.push_back(d[0]);
+    }
+
+    // buffer keeps data of the last three updates only
+    CHECK(rv == eswb_e_timedout);
+    CHECK(popped == std::vector<int>({8, 9, 10}));
+}
+
+TEST_CASE("Event queue sub-queues") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t root_td;
+    rv = eswb_connect("itb:/bus", &root_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t fast_td;
+    eswb_topic_descr_t rare_td;
+    rv = eswb_proclaim_plain("itb:/bus", "fast", sizeof(uint32_t), &fast_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_proclaim_plain("itb:/bus", "rare", sizeof(uint32_t), &rare_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    rv = eswb_event_queue_enable_subch(root_td, 16, 16 * sizeof(uint32_t), 1 << 2);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_order_topic(root_td, "bus/fast", 1);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_order_topic(root_td, "bus/rare", 2);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t rare_q_td;
+    rv = eswb_event_queue_subscribe("itb:/bus", &rare_q_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_set_receive_mask(rare_q_td, 1 << 2);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t fast_q_td;
+    rv = eswb_event_queue_subscribe("itb:/bus", &fast_q_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_set_receive_mask(fast_q_td, 1 << 1);
+    REQUIRE(rv == eswb_e_ok);
+
+    for (uint32_t i = 0; i < 40; i++) {
+        rv = eswb_update_topic(fast_td, &i);
+        REQUIRE(rv == eswb_e_ok);
+        if ((i == 0) || (i == 30) || (i == 35)) {
+            rv = eswb_update_topic(rare_td, &i);
+            REQUIRE(rv == eswb_e_ok);
+        }
+    }
+
+    uint8_t event_buf[sizeof(event_queue_transfer_t) + 16 * sizeof(uint32_t)];
+    event_queue_transfer_t *event = (event_queue_transfer_t *) event_buf;
+
+    auto pop = [&](eswb_topic_descr_t td) {
+        eswb_arm_timeout(td, 10000);
+        return eswb_event_queue_pop(td, event);
+    };
+    auto value = [&]() {
+        return *((uint32_t *) EVENT_QUEUE_TRANSFER_DATA(event));
+    };
+
+    SECTION("Channel with sub-queue gets its events only") {
+        // the first event is pushed out of the queue by the fast topic
+        rv = pop(rare_q_td);
+        CHECK(rv == eswb_e_fifo_rcvr_underrun);
+        CHECK(event->type == eqr_topic_update);
+        CHECK(value() == 30);
+
+        rv = pop(rare_q_td);
+        CHECK(rv == eswb_e_ok);
+        CHECK(value() == 35);
+
+        rv = pop(rare_q_td);
+        CHECK(rv == eswb_e_timedout);
+    }
+
+    SECTION("Channel without sub-queue is filtered from the whole queue") {
+        // queue holds the last 16 events, two of them are of the rare topic
+        std::vector<uint32_t> popped;
+        while ((rv = pop(fast_q_td)) == eswb_e_ok || rv == eswb_e_fifo_rcvr_underrun) {
+            popped.push_back(value());
+        }
+        CHECK(rv == eswb_e_timedout);
+        CHECK(popped == std::vector<uint32_t>({26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39}));
+    }
+
+    SECTION("Switching back to the whole queue") {
+        rv = eswb_event_queue_set_receive_mask(rare_q_td, (1 << 1) | (1 << 2));
+        REQUIRE(rv == eswb_e_ok);
+
+        uint32_t v = 100;
+        rv = eswb_update_topic(rare_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+
+        rv = pop(rare_q_td);
+        CHECK(rv == eswb_e_ok);
+        CHECK(value() == 100);
+
+        rv = pop(rare_q_td);
+        CHECK(rv == eswb_e_timedout);
+    }
+}
+
+TEST_CASE("Conflating event queue") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("bus", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t root_td;
+    rv = eswb_connect("itb:/bus", &root_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t a_td;
+    eswb_topic_descr_t b_td;
+    rv = eswb_proclaim_plain("itb:/bus", "a", sizeof(uint32_t), &a_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_proclaim_plain("itb:/bus", "b", sizeof(uint32_t), &b_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    rv = eswb_event_queue_enable_conflating(root_td, 4, 4 * sizeof(uint32_t));
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_order_topic(root_td, "bus/*", 1);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t ev_q_td;
+    rv = eswb_event_queue_subscribe("itb:/bus", &ev_q_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_set_receive_mask(ev_q_td, 1 << 1);
+    REQUIRE(rv == eswb_e_ok);
+
+    uint8_t event_buf[sizeof(event_queue_transfer_t) + sizeof(uint32_t)];
+    event_queue_transfer_t *event = (event_queue_transfer_t *) event_buf;
+
+    // values of b are above 1000
+    std::vector<uint32_t> popped;
+    auto pop_all = [&]() {
+        popped.clear();
+        while (true) {
+            eswb_arm_timeout(ev_q_td, 10000);
+            rv = eswb_event_queue_pop(ev_q_td, event);
+            if (rv != eswb_e_ok) {
+                break;
+            }
+            REQUIRE(event->type == eqr_topic_update);
+            popped.push_back(*((uint32_t *) EVENT_QUEUE_TRANSFER_DATA(event)));
+        }
+        CHECK(rv == eswb_e_timedout);
+    };
+
+    uint32_t v;
+    for (v = 1; v <= 50; v++) {
+        eswb_update_topic(a_td, &v);
+    }
+    v = 1007;
+    eswb_update_topic(b_td, &v);
+    for (v = 51; v <= 100; v++) {
+        eswb_update_topic(a_td, &v);
+    }
+
+    SECTION("Latest value of every topic in order of updates") {
+        pop_all();
+        CHECK(popped == std::vector<uint32_t>({1007, 100}));
+    }
+
+    SECTION("Update of the topic consumer has just popped") {
+        eswb_arm_timeout(ev_q_td, 10000);
+        rv = eswb_event_queue_pop(ev_q_td, event);
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(*((uint32_t *) EVENT_QUEUE_TRANSFER_DATA(event)) == 1007);
+
+        v = 1008;
+        eswb_update_topic(b_td, &v);
+
+        pop_all();
+        CHECK(popped == std::vector<uint32_t>({100, 1008}));
+    }
+
+    SECTION("Nothing is pending after everything is popped") {
+        pop_all();
+
+        v = 200;
+        eswb_update_topic(a_td, &v);
+
+        pop_all();
+        CHECK(popped == std::vector<uint32_t>({200}));
+    }
+}
+
+TEST_CASE("Event queue timestamps and sequence numbers") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("src", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_create("dst", eswb_inter_thread, 20);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t src_td;
+    eswb_topic_descr_t dst_td;
+    rv = eswb_connect("itb:/src", &src_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_connect("itb:/dst", &dst_td);
+    REQUIRE(rv == eswb_e_ok);
+
+    rv = eswb_event_queue_set_timestamping(src_td, 1);
+    CHECK(rv == eswb_e_ev_queue_not_enabled);
+
+    for (eswb_topic_descr_t td : {src_td, dst_td}) {
+        rv = eswb_event_queue_enable(td, 16, 512);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_event_queue_order_topic(td, td == src_td ? "src" : "dst", 1);
+        REQUIRE(rv == eswb_e_ok);
+    }
+    rv = eswb_event_queue_set_timestamping(src_td, 1);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t src_q_td;
+    eswb_topic_descr_t dst_q_td;
+    rv = eswb_event_queue_subscribe("itb:/src", &src_q_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_set_receive_mask(src_q_td, (1 << 0) | (1 << 1));
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_subscribe("itb:/dst", &dst_q_td);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_event_queue_set_receive_mask(dst_q_td, 1 << 1);
+    REQUIRE(rv == eswb_e_ok);
+
+    auto now_ns = []() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+    };
+
+    uint64_t t_start = now_ns();
+
+    eswb_topic_descr_t td;
+    rv = eswb_proclaim_plain("itb:/src", "t", sizeof(uint32_t), &td);
+    REQUIRE(rv == eswb_e_ok);
+    for (uint32_t v = 0; v < 3; v++) {
+        rv = eswb_update_topic(td, &v);
+        REQUIRE(rv == eswb_e_ok);
+    }
+
+    uint64_t t_end = now_ns();
+
+    topic_id_map_t *tid_map;
+    rv = map_alloc(&tid_map, 10);
+    REQUIRE(rv == eswb_e_ok);
+
+    uint8_t event_buf[512];
+    event_queue_transfer_t *event = (event_queue_transfer_t *) event_buf;
+
+    std::vector<uint64_t> stamps;
+    std::vector<uint32_t> seqs;
+    uint32_t prev_seq = 0;
+    for (int i = 0; i < 4; i++) {
+        eswb_arm_timeout(src_q_td, 10000);
+        rv = eswb_event_queue_pop(src_q_td, event);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(event->type == (i == 0 ? eqr_topic_proclaim : eqr_topic_update));
+
+        // nothing else goes to the queue, so there are no gaps
+        if (i > 0) {
+            CHECK(event->seq == prev_seq + 1);
+        }
+        prev_seq = event->seq;
+        seqs.push_back(event->seq);
+
+        CHECK(event->timestamp >= t_start);
+        CHECK(event->timestamp <= t_end);
+        if (!stamps.empty()) {
+            CHECK(event->timestamp >= stamps.back());
+        }
+        stamps.push_back(event->timestamp);
+
+        rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+        REQUIRE(rv == eswb_e_ok);
+    }
+
+    SECTION("Replicated events keep time and number of origin") {
+        for (int i = 0; i < 4; i++) {
+            eswb_arm_timeout(dst_q_td, 10000);
+            rv = eswb_event_queue_pop(dst_q_td, event);
+            REQUIRE(rv == eswb_e_ok);
+            CHECK(event->type == (i == 0 ? eqr_topic_proclaim : eqr_topic_update));
+            CHECK(event->timestamp == stamps[i]);
+            CHECK(event->seq == seqs[i]);
+        }
+    }
+
+    SECTION("Events lost on the way are detected on replica") {
+        eswb_topic_descr_t pub_td;
+        rv = eswb_connect("itb:/src/t", &pub_td);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_fifo_flush(dst_q_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        // second update is not replicated
+        for (uint32_t v = 10; v < 13; v++) {
+            rv = eswb_update_topic(pub_td, &v);
+            REQUIRE(rv == eswb_e_ok);
+            eswb_arm_timeout(src_q_td, 10000);
+            rv = eswb_event_queue_pop(src_q_td, event);
+            REQUIRE(rv == eswb_e_ok);
+            if (v != 11) {
+                rv = eswb_event_queue_replicate(dst_td, tid_map, event);
+                REQUIRE(rv == eswb_e_ok);
+            }
+        }
+
+        uint32_t replica_seq[2];
+        for (int i = 0; i < 2; i++) {
+            eswb_arm_timeout(dst_q_td, 10000);
+            rv = eswb_event_queue_pop(dst_q_td, event);
+            REQUIRE(rv == eswb_e_ok);
+            replica_seq[i] = event->seq;
+        }
+        CHECK(replica_seq[1] == replica_seq[0] + 2);
+    }
+
+    SECTION("Local updates of replica are not stamped while its timestamping is off") {
+        eswb_topic_descr_t replica_td;
+        rv = eswb_connect("itb:/dst/t", &replica_td);
+        REQUIRE(rv == eswb_e_ok);
+        rv = eswb_fifo_flush(dst_q_td);
+        REQUIRE(rv == eswb_e_ok);
+
+        uint32_t v = 100;
+        rv = eswb_update_topic(replica_td, &v);
+        REQUIRE(rv == eswb_e_ok);
+
+        eswb_arm_timeout(dst_q_td, 10000);
+        rv = eswb_event_queue_pop(dst_q_td, event);
+        REQUIRE(rv == eswb_e_ok);
+        CHECK(event->timestamp == 0);
+    }
+
+    map_dealloc(tid_map);
+}
+
+TEST_CASE("Bridge snapshot") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    rv = eswb_create("snap_src", eswb_inter_thread, 16);
+    REQUIRE(rv == eswb_e_ok);
+    rv = eswb_create("snap_dst", eswb_inter_thread, 16);
+    REQUIRE(rv == eswb_e_ok);
+
+    eswb_topic_descr_t a_td;
+    eswb_topic_descr_t b_td;
+    REQUIRE(eswb_proclaim_plain("itb:/snap_src", "a", sizeof(uint32_t), &a_td) == eswb_e_ok);
+    REQUIRE(eswb_proclaim_plain("itb:/snap_src", "b", sizeof(uint32_t), &b_td) == eswb_e_ok);
+
+    eswb_bridge_t *br;
+    REQUIRE(eswb_bridge_create("ab", 2, &br) == eswb_e_ok);
+    REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/snap_src/a", NULL) == eswb_e_ok);
+    REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/snap_src/b", NULL) == eswb_e_ok);
+    REQUIRE(eswb_bridge_connect(br, 0, "itb:/snap_dst") == eswb_e_ok);
+
+    SECTION("Version changes on update") {
+        uint32_t v1, v2;
+        uint32_t val = 1;
+        REQUIRE(eswb_get_version(a_td, &v1) == eswb_e_ok);
+        REQUIRE(eswb_update_topic(a_td, &val) == eswb_e_ok);
+        REQUIRE(eswb_get_version(a_td, &v2) == eswb_e_ok);
+        REQUIRE(v1 != v2);
+
+        REQUIRE(eswb_get_version(b_td, &v1) == eswb_e_ok);
+        REQUIRE(eswb_update_topic(a_td, &val) == eswb_e_ok);
+        REQUIRE(eswb_get_version(b_td, &v2) == eswb_e_ok);
+        REQUIRE(v1 == v2);
+    }
+
+    SECTION("Snapshot is a consistent cut") {
+        std::atomic<bool> stop(false);
+
+        // a is always updated before b, so any moment has a == b or a == b + 1
+        std::thread writer([&] () {
+            for (uint32_t v = 1; !stop.load(); v++) {
+                eswb_update_topic(a_td, &v);
+                eswb_update_topic(b_td, &v);
+            }
+        });
+
+        struct {
+            uint32_t a;
+            uint32_t b;
+        } ab;
+
+        int snapshots = 0;
+        int torn = 0;
+        for (int n = 0; n < 100000; n++) {
+            rv = eswb_bridge_read_snapshot(br, &ab);
+            if (rv == eswb_e_sync_inconsistent) {
+                continue;
+            }
+            REQUIRE(rv == eswb_e_ok);
+            snapshots++;
+            if ((ab.a != ab.b) && (ab.a != ab.b + 1)) {
+                torn++;
+            }
+        }
+
+        stop = true;
+        writer.join();
+
+        CHECK(snapshots > 0);
+        REQUIRE(torn == 0);
+
+        REQUIRE(eswb_bridge_update_snapshot(br) == eswb_e_ok);
+        eswb_topic_descr_t dst_td;
+        REQUIRE(eswb_connect("itb:/snap_dst/ab", &dst_td) == eswb_e_ok);
+        REQUIRE(eswb_read(dst_td, &ab) == eswb_e_ok);
+        REQUIRE(ab.a == ab.b);
+    }
+}
+
+TEST_CASE("Reactive bridge") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    REQUIRE(eswb_create("react_src", eswb_inter_thread, 16) == eswb_e_ok);
+    REQUIRE(eswb_create("react_dst", eswb_inter_thread, 16) == eswb_e_ok);
+
+    eswb_topic_descr_t a_td;
+    eswb_topic_descr_t b_td;
+    REQUIRE(eswb_proclaim_plain("itb:/react_src", "a", sizeof(uint32_t), &a_td) == eswb_e_ok);
+    REQUIRE(eswb_proclaim_plain("itb:/react_src", "b", sizeof(uint32_t), &b_td) == eswb_e_ok);
+
+    eswb_bridge_t *br;
+    REQUIRE(eswb_bridge_create("ab", 2, &br) == eswb_e_ok);
+    REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/react_src/a", NULL) == eswb_e_ok);
+    REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/react_src/b", NULL) == eswb_e_ok);
+    REQUIRE(eswb_bridge_connect(br, 0, "itb:/react_dst") == eswb_e_ok);
+
+    eswb_topic_descr_t dst_td;
+    REQUIRE(eswb_connect("itb:/react_dst/ab", &dst_td) == eswb_e_ok);
+
+    struct {
+        uint32_t a;
+        uint32_t b;
+    } ab;
+    uint32_t val;
+
+    SECTION("Any source") {
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_timedout);
+
+        // update done before the call is not missed
+        val = 1;
+        eswb_update_topic(a_td, &val);
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_ok);
+        REQUIRE(eswb_read(dst_td, &ab) == eswb_e_ok);
+        REQUIRE(ab.a == 1);
+
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_timedout);
+
+        std::thread publisher([&] () {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            uint32_t v = 2;
+            eswb_update_topic(b_td, &v);
+        });
+        rv = eswb_bridge_wait_update(br, 0);
+        publisher.join();
+        REQUIRE(rv == eswb_e_ok);
+        REQUIRE(eswb_read(dst_td, &ab) == eswb_e_ok);
+        REQUIRE(ab.a == 1);
+        REQUIRE(ab.b == 2);
+    }
+
+    SECTION("All sources") {
+        REQUIRE(eswb_bridge_set_trigger(br, eswb_bridge_on_all, 0) == eswb_e_ok);
+
+        val = 1;
+        eswb_update_topic(a_td, &val);
+        eswb_update_topic(a_td, &val);
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_timedout);
+
+        eswb_update_topic(b_td, &val);
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_ok);
+        REQUIRE(eswb_read(dst_td, &ab) == eswb_e_ok);
+        REQUIRE(ab.a == 1);
+        REQUIRE(ab.b == 1);
+
+        eswb_update_topic(b_td, &val);
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_timedout);
+    }
+
+    SECTION("Minimal interval") {
+        REQUIRE(eswb_bridge_set_trigger(br, eswb_bridge_on_any, 50000) == eswb_e_ok);
+
+        val = 1;
+        eswb_update_topic(a_td, &val);
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_ok);
+
+        auto t0 = std::chrono::steady_clock::now();
+        val = 2;
+        eswb_update_topic(a_td, &val);
+        REQUIRE(eswb_bridge_wait_update(br, 10000) == eswb_e_ok);
+        auto dt = std::chrono::steady_clock::now() - t0;
+        REQUIRE(dt >= std::chrono::milliseconds(45));
+
+        REQUIRE(eswb_read(dst_td, &ab) == eswb_e_ok);
+        REQUIRE(ab.a == 2);
+    }
+}
+
+TEST_CASE("Aliasing bridge") {
+    eswb_local_init(1);
+
+    REQUIRE(eswb_create("alias_src", eswb_inter_thread, 16) == eswb_e_ok);
+    REQUIRE(eswb_create("alias_dst", eswb_inter_thread, 16) == eswb_e_ok);
+
+    struct abc {
+        double a;
+        double b;
+        double c;
+    } st = {};
+
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 4);
+    topic_proclaiming_tree_t *rt = usr_topic_set_struct(cntx, st, "st");
+    usr_topic_add_struct_child(cntx, rt, struct abc, a, "a", tt_double);
+    usr_topic_add_struct_child(cntx, rt, struct abc, b, "b", tt_double);
+    usr_topic_add_struct_child(cntx, rt, struct abc, c, "c", tt_double);
+
+    eswb_topic_descr_t st_td;
+    REQUIRE(eswb_proclaim_tree_by_path("itb:/alias_src", rt, cntx->t_num, &st_td) == eswb_e_ok);
+
+    eswb_bridge_t *br;
+
+    SECTION("Contiguous members") {
+        REQUIRE(eswb_bridge_create("ab", 2, &br) == eswb_e_ok);
+        REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/alias_src/st/a", NULL) == eswb_e_ok);
+        REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/alias_src/st/b", "bb") == eswb_e_ok);
+        REQUIRE(eswb_bridge_connect_alias(br, 0, "itb:/alias_dst") == eswb_e_ok);
+        REQUIRE(br->buffer2post == NULL);
+
+        eswb_topic_descr_t ab_td;
+        eswb_topic_descr_t bb_td;
+        REQUIRE(eswb_connect("itb:/alias_dst/ab", &ab_td) == eswb_e_ok);
+        REQUIRE(eswb_connect("itb:/alias_dst/ab/bb", &bb_td) == eswb_e_ok);
+
+        st = {1.0, 2.0, 3.0};
+        REQUIRE(eswb_update_topic(st_td, &st) == eswb_e_ok);
+
+        double ab[2];
+        REQUIRE(eswb_read(ab_td, ab) == eswb_e_ok);
+        REQUIRE(ab[0] == 1.0);
+        REQUIRE(ab[1] == 2.0);
+
+        double bb;
+        REQUIRE(eswb_read(bb_td, &bb) == eswb_e_ok);
+        REQUIRE(bb == 2.0);
+
+        REQUIRE(eswb_bridge_update(br) == eswb_e_ok);
+
+        // source update wakes up the alias subscriber, as they share sync
+        std::thread publisher([&] () {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            struct abc w = {4.0, 5.0, 6.0};
+            eswb_update_topic(st_td, &w);
+        });
+        REQUIRE(eswb_get_update(ab_td, ab) == eswb_e_ok);
+        publisher.join();
+        REQUIRE(ab[0] == 4.0);
+        REQUIRE(ab[1] == 5.0);
+    }
+
+    SECTION("Whole structure") {
+        REQUIRE(eswb_bridge_create("whole", 1, &br) == eswb_e_ok);
+        REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/alias_src/st", NULL) == eswb_e_ok);
+        REQUIRE(eswb_bridge_connect_alias(br, 0, "itb:/alias_dst/st_alias") == eswb_e_ok);
+
+        st = {1.0, 2.0, 3.0};
+        REQUIRE(eswb_update_topic(st_td, &st) == eswb_e_ok);
+
+        eswb_topic_descr_t c_td;
+        REQUIRE(eswb_connect("itb:/alias_dst/st_alias/c", &c_td) == eswb_e_ok);
+        double c;
+        REQUIRE(eswb_read(c_td, &c) == eswb_e_ok);
+        REQUIRE(c == 3.0);
+    }
+
+    SECTION("Not contiguous members") {
+        REQUIRE(eswb_bridge_create("ac", 2, &br) == eswb_e_ok);
+        REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/alias_src/st/a", NULL) == eswb_e_ok);
+        REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/alias_src/st/c", NULL) == eswb_e_ok);
+        REQUIRE(eswb_bridge_connect_alias(br, 0, "itb:/alias_dst") == eswb_e_invargs);
+    }
+
+    SECTION("Differently synced buses") {
+        REQUIRE(eswb_create("alias_nsb", eswb_non_synced, 16) == eswb_e_ok);
+        REQUIRE(eswb_bridge_create("ab", 2, &br) == eswb_e_ok);
+        REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/alias_src/st/a", NULL) == eswb_e_ok);
+        REQUIRE(eswb_bridge_add_topic(br, 0, "itb:/alias_src/st/b", NULL) == eswb_e_ok);
+        REQUIRE(eswb_bridge_connect_alias(br, 0, "nsb:/alias_nsb") == eswb_e_not_supported);
+    }
+}
+
+TEST_CASE("Topic counters") {
+    eswb_rv_t rv;
+
+    eswb_local_init(1);
+
+    REQUIRE(eswb_create("cnt", eswb_inter_thread, 64) == eswb_e_ok);
+
+    eswb_topic_descr_t t_td;
+    REQUIRE(eswb_proclaim_plain("itb:/cnt", "t", sizeof(uint32_t), &t_td) == eswb_e_ok);
+
+    TOPIC_TREE_CONTEXT_LOCAL_DEFINE(cntx, 2);
+    topic_proclaiming_tree_t *fifo_root = usr_topic_set_fifo(cntx, "fifo", 4);
+    usr_topic_add_child(cntx, fifo_root, "elem", tt_uint32, 0, 4, TOPIC_FLAG_MAPPED_TO_PARENT);
+    eswb_topic_descr_t push_td;
+    REQUIRE(eswb_proclaim_tree_by_path("itb:/cnt", fifo_root, cntx->t_num, &push_td) == eswb_e_ok);
+    eswb_topic_descr_t pop_td;
+    REQUIRE(eswb_fifo_subscribe("itb:/cnt/fifo/elem", &pop_td) == eswb_e_ok);
+
+    uint32_t v = 1;
+    topic_counters_t c;
+
+    // nothing is counted while disabled
+    REQUIRE(eswb_update_topic(t_td, &v) == eswb_e_ok);
+    REQUIRE(eswb_get_topic_counters(t_td, &c) == eswb_e_ok);
+    REQUIRE(c.updates == 0);
+
+    REQUIRE(eswb_bus_enable_counters(t_td, 1) == eswb_e_ok);
+
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(eswb_update_topic(t_td, &v) == eswb_e_ok);
+    }
+    REQUIRE(eswb_read(t_td, &v) == eswb_e_ok);
+    REQUIRE(eswb_arm_timeout(t_td, 1000) == eswb_e_ok);
+    REQUIRE(eswb_get_update(t_td, &v) == eswb_e_timedout);
+
+    REQUIRE(eswb_get_topic_counters(t_td, &c) == eswb_e_ok);
+    CHECK(c.updates == 3);
+    CHECK(c.reads == 1);
+    CHECK(c.waits == 1);
+    CHECK(c.timeouts == 1);
+    CHECK(c.bytes == 4 * sizeof(uint32_t));
+    CHECK(c.last_update_ns > 0);
+
+    for (uint32_t i = 0; i < 6; i++) {
+        REQUIRE(eswb_fifo_push(push_td, &i) == eswb_e_ok);
+    }
+    rv = eswb_fifo_pop(pop_td, &v);
+    REQUIRE(rv == eswb_e_fifo_rcvr_underrun);
+    REQUIRE(eswb_fifo_pop(pop_td, &v) == eswb_e_ok);
+
+    REQUIRE(eswb_get_topic_counters(pop_td, &c) == eswb_e_ok);
+    CHECK(c.fifo_underruns == 1);
+    CHECK(c.reads == 1);
+    CHECK(c.waits == 0);
+
+    SECTION("Published to bus") {
+        REQUIRE(eswb_bus_publish_stats(t_td) == eswb_e_ok);
+
+        eswb_topic_id_t tid = 0;
+        topic_extract_t info;
+        eswb_topic_id_t t_id = 0;
+        eswb_topic_descr_t root_td;
+        REQUIRE(eswb_connect("itb:/cnt", &root_td) == eswb_e_ok);
+        while (eswb_get_next_topic_info(root_td, &tid, &info) == eswb_e_ok) {
+            if (strcmp(info.info.name, "t") == 0) {
+                t_id = info.info.topic_id;
+            }
+        }
+        REQUIRE(t_id != 0);
+
+        std::string stats_path = "itb:/cnt/" BUS_STATS_DIR_NAME "/" + std::to_string(t_id);
+        eswb_topic_descr_t stats_td;
+        REQUIRE(eswb_connect(stats_path.c_str(), &stats_td) == eswb_e_ok);
+
+        topic_counters_t pc;
+        REQUIRE(eswb_read(stats_td, &pc) == eswb_e_ok);
+        CHECK(pc.updates == 3);
+
+        uint32_t updates;
+        eswb_topic_descr_t updates_td;
+        REQUIRE(eswb_connect((stats_path + "/updates").c_str(), &updates_td) == eswb_e_ok);
+
+        REQUIRE(eswb_update_topic(t_td, &v) == eswb_e_ok);
+        REQUIRE(eswb_bus_publish_stats(t_td) == eswb_e_ok);
+        REQUIRE(eswb_read(updates_td, &updates) == eswb_e_ok);
+        CHECK(updates == 4);
+
+        // idle topics are not published
+        eswb_topic_descr_t idle_td;
+        REQUIRE(eswb_proclaim_plain("itb:/cnt", "idle", sizeof(uint32_t), &idle_td) == eswb_e_ok);
+        bus_stats_t bs1, bs2;
+        REQUIRE(eswb_get_bus_stats(t_td, &bs1) == eswb_e_ok);
+        REQUIRE(eswb_bus_publish_stats(t_td) == eswb_e_ok);
+        REQUIRE(eswb_get_bus_stats(t_td, &bs2) == eswb_e_ok);
+        CHECK(bs1.topics_num == bs2.topics_num);
+    }
+}
+
+TEST_CASE("Topic counters published by several processes") {
+    eswb_local_init(1);
+
+    // forked before the bus exists, so the child gets its own handle of the bus, knowing nothing about
+    // statistics topics proclaimed by the parent
+    int go_pipe[2];
+    REQUIRE(pipe(go_pipe) == 0);
+
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+
+    if (pid == 0) {
+        char c;
+        close(go_pipe[1]);
+        if (read(go_pipe[0], &c, 1) != 1) {
+            _exit(1);
+        }
+
+        eswb_topic_descr_t td;
+        uint32_t v = 2;
+        if (eswb_connect("ipb:/cntp/t", &td) != eswb_e_ok) {
+            _exit(2);
+        }
+        if (eswb_update_topic(td, &v) != eswb_e_ok) {
+            _exit(3);
+        }
+        _exit(eswb_bus_publish_stats(td) == eswb_e_ok ? 0 : 4);
+    }
+
+    close(go_pipe[0]);
+
+    REQUIRE(eswb_create("cntp", eswb_inter_process, 64) == eswb_e_ok);
+
+    eswb_topic_descr_t t_td;
+    REQUIRE(eswb_proclaim_plain("ipb:/cntp", "t", sizeof(uint32_t), &t_td) == eswb_e_ok);
+    REQUIRE(eswb_bus_enable_counters(t_td, 1) == eswb_e_ok);
+
+    uint32_t v = 1;
+    REQUIRE(eswb_update_topic(t_td, &v) == eswb_e_ok);
+    REQUIRE(eswb_bus_publish_stats(t_td) == eswb_e_ok);
+
+    bus_stats_t bs1, bs2;
+    REQUIRE(eswb_get_bus_stats(t_td, &bs1) == eswb_e_ok);
+
+    char c = 1;
+    REQUIRE(write(go_pipe[1], &c, 1) == 1);
+    close(go_pipe[1]);
+
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+
+    // child reused statistics topics instead of proclaiming duplicates
+    REQUIRE(eswb_get_bus_stats(t_td, &bs2) == eswb_e_ok);
+    CHECK(bs1.topics_num == bs2.topics_num);
+
+    eswb_topic_descr_t updates_td;
+    REQUIRE(eswb_connect("ipb:/cntp/" BUS_STATS_DIR_NAME "/1/updates", &updates_td) == eswb_e_ok);
+    uint32_t updates = 0;
+    REQUIRE(eswb_read(updates_td, &updates) == eswb_e_ok);
+    CHECK(updates == 2);
+
+    REQUIRE(eswb_delete("ipb:/cntp") == eswb_e_ok);
+}
+
+TEST_CASE("Wakeup latency histogram") {
+    eswb_local_init(1);
+
+    REQUIRE(eswb_create("wake", eswb_inter_thread, 16) == eswb_e_ok);
+
+    eswb_topic_descr_t pub_td;
+    REQUIRE(eswb_proclaim_plain("itb:/wake", "t", sizeof(uint32_t), &pub_td) == eswb_e_ok);
+    eswb_topic_descr_t sub_td;
+    REQUIRE(eswb_connect("itb:/wake/t", &sub_td) == eswb_e_ok);
+
+    auto hist_sum = [] (const topic_wakeup_hist_t &h) {
+        uint32_t sum = 0;
+        for (int i = 0; i < ESWB_WAKEUP_HIST_BUCKETS; i++) {
+            sum += h.buckets[i];
+        }
+        return sum;
+    };
+
+    auto blocked_update = [&] () {
+        uint32_t v;
+        std::thread publisher([&] () {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            uint32_t w = 1;
+            eswb_update_topic(pub_td, &w);
+        });
+        REQUIRE(eswb_get_update(sub_td, &v) == eswb_e_ok);
+        publisher.join();
+    };
+
+    topic_wakeup_hist_t h;
+
+    // not measured while bus's counters are disabled
+    blocked_update();
+    REQUIRE(eswb_get_wakeup_hist(sub_td, &h) == eswb_e_ok);
+    REQUIRE(hist_sum(h) == 0);
+
+    REQUIRE(eswb_bus_enable_counters(sub_td, 1) == eswb_e_ok);
+    blocked_update();
+    blocked_update();
+    REQUIRE(eswb_get_wakeup_hist(sub_td, &h) == eswb_e_ok);
+    REQUIRE(hist_sum(h) == 2);
+    // publisher slept for 20 ms before the update, it doesn't count in the latency
+    int filled = 0;
+    for (int i = 0; i < ESWB_WAKEUP_HIST_BUCKETS; i++) {
+        if (h.buckets[i] > 0) {
+            filled++;
+            CHECK(i < 24);
+        }
+    }
+    CHECK(filled > 0);
+
+    // timed out wait is not a wakeup
+    uint32_t v;
+    REQUIRE(eswb_arm_timeout(sub_td, 1000) == eswb_e_ok);
+    REQUIRE(eswb_get_update(sub_td, &v) == eswb_e_timedout);
+    REQUIRE(eswb_get_wakeup_hist(sub_td, &h) == eswb_e_ok);
+    REQUIRE(hist_sum(h) == 2);
 }
 
 TEST_CASE("Retrieve tree struct") {
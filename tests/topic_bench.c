@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "eswb/api.h"
+#include "eswb/event_queue.h"
+
+/*
+ * Microbenchmark of topics read / update path over a bus with many topics
+ */
+
+#define BENCH_TOPICS 4096
+
+static eswb_topic_descr_t pub_tds[BENCH_TOPICS];
+static eswb_topic_descr_t sub_tds[BENCH_TOPICS];
+static uint32_t order[BENCH_TOPICS];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static void report(const char *name, double dt_ns, long ops) {
+    printf("%-36s %10.1f ns/op\n", name, dt_ns / (double) ops);
+}
+
+static void setup(eswb_type_t type, const char *bus_path) {
+    char name[16];
+
+    eswb_local_init(1);
+    if (eswb_create("bench", type, BENCH_TOPICS + 1) != eswb_e_ok) {
+        fprintf(stderr, "eswb_create failed\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < BENCH_TOPICS; i++) {
+        snprintf(name, sizeof(name), "t%d", i);
+        if (eswb_proclaim_plain(bus_path, name, sizeof(uint64_t), &pub_tds[i]) != eswb_e_ok) {
+            fprintf(stderr, "eswb_proclaim_plain failed\n");
+            exit(1);
+        }
+        sub_tds[i] = pub_tds[i];
+    }
+
+    // shuffled order, so every access misses caches like it does in a big application
+    for (int i = 0; i < BENCH_TOPICS; i++) {
+        order[i] = i;
+    }
+    srand(1);
+    for (int i = BENCH_TOPICS - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        uint32_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+}
+
+static void bench_update(const char *name, long n) {
+    uint64_t v = 0;
+
+    double t0 = now_ns();
+    for (long i = 0; i < n; i++) {
+        v++;
+        eswb_update_topic(pub_tds[order[i % BENCH_TOPICS]], &v);
+    }
+    report(name, now_ns() - t0, n);
+}
+
+static void bench_read(const char *name, long n) {
+    uint64_t v;
+
+    double t0 = now_ns();
+    for (long i = 0; i < n; i++) {
+        eswb_read(sub_tds[order[i % BENCH_TOPICS]], &v);
+    }
+    report(name, now_ns() - t0, n);
+}
+
+typedef struct {
+    int first;
+    long n;
+} writer_arg_t;
+
+static void *writer_thread(void *arg) {
+    writer_arg_t *wa = arg;
+    uint64_t v = 0;
+
+    for (long i = 0; i < wa->n; i++) {
+        v++;
+        // interleaved with the other writer, so neighbour topics are written by different threads
+        eswb_update_topic(pub_tds[(i * 2 + wa->first) % BENCH_TOPICS], &v);
+    }
+
+    return NULL;
+}
+
+static void bench_two_writers(const char *name, long n) {
+    pthread_t tids[2];
+    writer_arg_t args[2] = {{.first = 0, .n = n}, {.first = 1, .n = n}};
+
+    double t0 = now_ns();
+    for (int i = 0; i < 2; i++) {
+        pthread_create(&tids[i], NULL, writer_thread, &args[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    report(name, now_ns() - t0, n * 2);
+}
+
+static void bench_event_queue(eswb_size_t queue_size, long n) {
+    char bus_name[16];
+    char bus_path[24];
+    char name[48];
+    eswb_topic_descr_t root_td;
+    eswb_topic_descr_t td;
+    uint64_t v = 0;
+
+    snprintf(bus_name, sizeof(bus_name), "evq%u", queue_size);
+    snprintf(bus_path, sizeof(bus_path), "itb:/%s", bus_name);
+
+    // topic inherits ordering from the bus root
+    if ((eswb_create(bus_name, eswb_inter_thread, 16) != eswb_e_ok) ||
+        (eswb_connect(bus_path, &root_td) != eswb_e_ok) ||
+        (eswb_event_queue_enable(root_td, queue_size, queue_size * sizeof(v)) != eswb_e_ok) ||
+        (eswb_event_queue_order_topic(root_td, bus_name, 1) != eswb_e_ok) ||
+        (eswb_proclaim_plain(bus_path, "t", sizeof(v), &td) != eswb_e_ok)) {
+        fprintf(stderr, "event queue setup failed\n");
+        exit(1);
+    }
+
+    double t0 = now_ns();
+    for (long i = 0; i < n; i++) {
+        v++;
+        eswb_update_topic(td, &v);
+    }
+
+    snprintf(name, sizeof(name), "itb update, event queue of %u", queue_size);
+    report(name, now_ns() - t0, n);
+}
+
+int main(int argc, char *argv[]) {
+    long n = argc > 1 ? atol(argv[1]) : 4000000;
+
+    setup(eswb_non_synced, "nsb:/bench");
+    bench_update("nsb update, shuffled topics", n);
+    bench_read("nsb read, shuffled topics", n);
+
+    setup(eswb_inter_thread, "itb:/bench");
+    bench_update("itb update, shuffled topics", n);
+    bench_read("itb read, shuffled topics", n);
+    bench_two_writers("itb two writers, adjacent topics", n);
+
+    for (eswb_size_t q = 64; q <= 4096; q *= 4) {
+        bench_event_queue(q, n / 20);
+    }
+
+    return 0;
+}